@@ -0,0 +1,427 @@
+/* ____________________________________________________________________________
+
+    Module bench.c
+    This module is a microbenchmark of the containers which are used on the
+    hot paths of loading and solving: hashTable, arrayList and intQueue.
+    Every operation is measured for node ids of the patterns which occur in
+    the networks (see benchKey) and for several sizes, time of the setup
+    is not measured. Calls of malloc, calloc and realloc are counted by
+    wrappers which the linker puts in place of them (--wrap, see Makefile),
+    so allocations of the containers are counted, not those of the C
+    library. The program is built by make bench.
+   ____________________________________________________________________________
+*/
+#ifdef __unix__
+#define _POSIX_C_SOURCE 199309L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "structs.h"
+#include "hashTable.h"
+#include "arrayList.h"
+#include "intQueue.h"
+#include "inputOutput.h"
+
+#define BENCH_MIN_OPS 1000000L
+#define BENCH_FIRST_SIZE 1000L
+#define BENCH_LAST_SIZE 1000000L
+#define BENCH_STRIDE 7919L
+#define BENCH_OFFSET 1000L
+#define BENCH_SCRAMBLE 2654435761UL
+#define BENCH_DISTRIBUTIONS 3
+
+/* patterns of node ids, see benchKey */
+static char *benchDistributions[BENCH_DISTRIBUTIONS] = {"dense", "strided", "sparse"};
+
+static unsigned long benchAllocs = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+/* ____________________________________________________________________________
+
+    void *__wrap_malloc(size_t size)
+    void *__wrap_calloc(size_t count, size_t size)
+    void *__wrap_realloc(void *pointer, size_t size)
+
+    Count the allocation and pass it to the C library.
+   ____________________________________________________________________________
+*/
+void *__wrap_malloc(size_t size) {
+    benchAllocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    benchAllocs++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    benchAllocs++;
+    return __real_realloc(pointer, size);
+}
+
+/* ____________________________________________________________________________
+
+    double benchNow()
+
+    Returns current time in seconds, monotonic wall clock where it's
+    available, processor time otherwise.
+   ____________________________________________________________________________
+*/
+static double benchNow() {
+#ifdef __unix__
+    struct timespec now;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+    return (double) clock() / CLOCKS_PER_SEC;
+}
+
+/* ____________________________________________________________________________
+
+    int benchKey(int distribution, long i)
+
+    Returns i-th node id of the distribution. Dense ids go 1, 2, 3 ... as in
+    generated grids, strided ids are BENCH_STRIDE apart as in the road
+    network exports and sparse ids are scattered over the whole positive
+    range as ids of map data. Ids of every distribution are unique, so ids
+    from count on are missing in a table of count nodes.
+   ____________________________________________________________________________
+*/
+static int benchKey(int distribution, long i) {
+    switch (distribution) {
+        case 0:
+            return (int) (i + 1);
+        case 1:
+            return (int) (BENCH_OFFSET + i * BENCH_STRIDE);
+        default:
+            /* multiplication by odd number is a permutation modulo 2^31 */
+            return (int) (((unsigned long) (i + 1) * BENCH_SCRAMBLE) & 0x7FFFFFFFUL);
+    }
+}
+
+/* ____________________________________________________________________________
+
+    long benchRounds(long size)
+
+    Returns how many times an operation over size items is repeated, so
+    at least BENCH_MIN_OPS operations are measured.
+   ____________________________________________________________________________
+*/
+static long benchRounds(long size) {
+    return size >= BENCH_MIN_OPS ? 1 : BENCH_MIN_OPS / size;
+}
+
+/* ____________________________________________________________________________
+
+    void benchReport(char *name, char *keys, long size, long ops,
+                     double seconds, unsigned long allocs)
+
+    Prints one line of results.
+   ____________________________________________________________________________
+*/
+static void benchReport(char *name, char *keys, long size, long ops, double seconds, unsigned long allocs) {
+    printf("%-24s %-8s %9ld %11ld %9.1f %10.3f\n", name, keys, size, ops, seconds * 1e9 / ops,
+           (double) allocs / ops);
+}
+
+/* ____________________________________________________________________________
+
+    hashTable *benchFillTable(int distribution, long size)
+
+    Returns table of size nodes with ids of the distribution, the table is
+    sized by the count of nodes as in loadNodes. Returns NULL if it can't
+    be allocated.
+   ____________________________________________________________________________
+*/
+static hashTable *benchFillTable(int distribution, long size) {
+    long i;
+    graphNode *node;
+    hashTable *table = createHashTable((int) size + 2, sizeof(graphNode));
+
+    if (!table) return NULL;
+
+    for (i = 0; i < size; i++) {
+        node = calloc(1, sizeof(graphNode));
+        if (!node) {
+            freeHashTable(&table);
+            return NULL;
+        }
+        node->id = benchKey(distribution, i);
+        hashTableAddElement(node, node->id, table);
+    }
+
+    return table;
+}
+
+/* ____________________________________________________________________________
+
+    void benchShuffle(int *keys, long count)
+
+    Shuffles the keys by a fixed sequence, so every run looks them up in
+    the same order.
+   ____________________________________________________________________________
+*/
+static void benchShuffle(int *keys, long count) {
+    long i;
+    long j;
+    int key;
+    unsigned long state = 12345;
+
+    for (i = count - 1; i > 0; i--) {
+        state = (state * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+        j = (long) ((state >> 8) % (unsigned long) (i + 1));
+        key = keys[i];
+        keys[i] = keys[j];
+        keys[j] = key;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int benchHashTable(int distribution, long size)
+
+    Measures hashTableAddElement and hashTableGetElement of present and
+    missing ids in random order. Returns SUCCESS or FAILURE if memory
+    couldn't be allocated.
+   ____________________________________________________________________________
+*/
+static int benchHashTable(int distribution, long size) {
+    long i;
+    long round;
+    long rounds = benchRounds(size);
+    double start;
+    double seconds = 0;
+    unsigned long allocs = 0;
+    int *keys;
+    graphNode **nodes;
+    hashTable *table;
+
+    keys = malloc(2 * size * sizeof(int));
+    nodes = malloc(size * sizeof(graphNode *));
+    if (!keys || !nodes) {
+        free(keys);
+        free(nodes);
+        return FAILURE;
+    }
+
+    /* nodes are allocated before the clock starts and freed with the table */
+    for (round = 0; round < rounds; round++) {
+        table = createHashTable((int) size + 2, sizeof(graphNode));
+        for (i = 0; i < size; i++) {
+            nodes[i] = calloc(1, sizeof(graphNode));
+            if (!nodes[i]) break;
+            nodes[i]->id = benchKey(distribution, i);
+        }
+        if (i < size) {
+            while (--i >= 0) free(nodes[i]);
+            freeHashTable(&table);
+            free(keys);
+            free(nodes);
+            return FAILURE;
+        }
+
+        allocs -= benchAllocs;
+        start = benchNow();
+        for (i = 0; i < size; i++) hashTableAddElement(nodes[i], nodes[i]->id, table);
+        seconds += benchNow() - start;
+        allocs += benchAllocs;
+        freeHashTable(&table);
+    }
+    benchReport("hashTableAddElement", benchDistributions[distribution], size, rounds * size, seconds, allocs);
+    free(nodes);
+
+    table = benchFillTable(distribution, size);
+    if (!table) {
+        free(keys);
+        return FAILURE;
+    }
+    for (i = 0; i < 2 * size; i++) keys[i] = benchKey(distribution, i);
+    benchShuffle(keys, size);
+    benchShuffle(keys + size, size);
+
+    seconds = 0;
+    allocs = benchAllocs;
+    for (round = 0; round < rounds; round++) {
+        start = benchNow();
+        for (i = 0; i < size; i++) hashTableGetElement(keys[i], table);
+        seconds += benchNow() - start;
+    }
+    benchReport("hashTableGetElement", benchDistributions[distribution], size, rounds * size, seconds,
+                benchAllocs - allocs);
+
+    seconds = 0;
+    allocs = benchAllocs;
+    for (round = 0; round < rounds; round++) {
+        start = benchNow();
+        for (i = size; i < 2 * size; i++) hashTableGetElement(keys[i], table);
+        seconds += benchNow() - start;
+    }
+    benchReport("hashTableGetElement/miss", benchDistributions[distribution], size, rounds * size, seconds,
+                benchAllocs - allocs);
+
+    freeHashTable(&table);
+    free(keys);
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int benchArrayList(long size)
+
+    Measures arrayListAdd from INITIAL_SIZE items, which grows the list by
+    INCREMENT items, and arrayListGetPointer in the order of the list and
+    in random order. Returns SUCCESS or FAILURE if memory couldn't be
+    allocated.
+   ____________________________________________________________________________
+*/
+static int benchArrayList(long size) {
+    long i;
+    long round;
+    long rounds = benchRounds(size);
+    double start;
+    double seconds = 0;
+    unsigned long allocs = 0;
+    int *order;
+    arrayList *list = NULL;
+
+    order = malloc(size * sizeof(int));
+    if (!order) return FAILURE;
+
+    /* items are not used, the list keeps pointers to the order array */
+    for (round = 0; round < rounds; round++) {
+        freeArrayList(&list);
+        list = createArrayList(INITIAL_SIZE, sizeof(graphEdge));
+        if (!list) {
+            free(order);
+            return FAILURE;
+        }
+
+        allocs -= benchAllocs;
+        start = benchNow();
+        for (i = 0; i < size; i++) arrayListAdd(list, order + i);
+        seconds += benchNow() - start;
+        allocs += benchAllocs;
+    }
+    benchReport("arrayListAdd", "-", size, rounds * size, seconds, allocs);
+
+    seconds = 0;
+    allocs = benchAllocs;
+    for (round = 0; round < rounds; round++) {
+        start = benchNow();
+        for (i = 0; i < size; i++) arrayListGetPointer(list, (int) i);
+        seconds += benchNow() - start;
+    }
+    benchReport("arrayListGetPointer", "-", size, rounds * size, seconds, benchAllocs - allocs);
+
+    for (i = 0; i < size; i++) order[i] = (int) i;
+    benchShuffle(order, size);
+    seconds = 0;
+    allocs = benchAllocs;
+    for (round = 0; round < rounds; round++) {
+        start = benchNow();
+        for (i = 0; i < size; i++) arrayListGetPointer(list, order[i]);
+        seconds += benchNow() - start;
+    }
+    benchReport("arrayListGetPointer/rnd", "-", size, rounds * size, seconds, benchAllocs - allocs);
+
+    freeArrayList(&list);
+    free(order);
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int benchIntQueue(int distribution, long size)
+
+    Measures intQueueEnque of node ids into queue of INITIAL_SIZE, which
+    expands as it goes, and intQueueExpand of a full queue whose items wrap
+    around the end of the array. Returns SUCCESS or FAILURE if memory
+    couldn't be allocated.
+   ____________________________________________________________________________
+*/
+static int benchIntQueue(int distribution, long size) {
+    long i;
+    long round;
+    long rounds = benchRounds(size);
+    int item;
+    double start;
+    double seconds = 0;
+    unsigned long allocs = 0;
+    intQueue *queue;
+
+    for (round = 0; round < rounds; round++) {
+        queue = createIntQueue(INITIAL_SIZE);
+        if (!queue) return FAILURE;
+
+        allocs -= benchAllocs;
+        start = benchNow();
+        for (i = 0; i < size; i++) intQueueEnque(queue, benchKey(distribution, i));
+        seconds += benchNow() - start;
+        allocs += benchAllocs;
+        intQueueFreeQueue(&queue);
+    }
+    benchReport("intQueueEnque", benchDistributions[distribution], size, rounds * size, seconds, allocs);
+
+    /* one expansion copies the whole queue, so it's repeated fewer times */
+    rounds = rounds < 3 ? 3 : rounds;
+    seconds = 0;
+    allocs = 0;
+    for (round = 0; round < rounds; round++) {
+        queue = createIntQueue((unsigned int) size);
+        if (!queue) return FAILURE;
+        for (i = 0; i < size / 2; i++) intQueueEnque(queue, benchKey(distribution, i));
+        for (i = 0; i < size / 2; i++) intQueueDeque(&item, queue);
+        for (i = 0; i < size; i++) intQueueEnque(queue, benchKey(distribution, i));
+
+        allocs -= benchAllocs;
+        start = benchNow();
+        intQueueExpand(queue);
+        seconds += benchNow() - start;
+        allocs += benchAllocs;
+        intQueueFreeQueue(&queue);
+    }
+    benchReport("intQueueExpand", benchDistributions[distribution], size, rounds, seconds, allocs);
+
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int main(int argc, char *argv[])
+
+    Runs all benchmarks for sizes from BENCH_FIRST_SIZE, every next size is
+    ten times bigger, up to BENCH_LAST_SIZE or the size given as the only
+    argument.
+   ____________________________________________________________________________
+*/
+int main(int argc, char *argv[]) {
+    int distribution;
+    long size;
+    long lastSize = argc > 1 ? strtol(argv[1], NULL, 10) : BENCH_LAST_SIZE;
+
+    if (lastSize < BENCH_FIRST_SIZE) {
+        printf("Invalid size.\n");
+        return 1;
+    }
+
+    printf("%-24s %-8s %9s %11s %9s %10s\n", "benchmark", "keys", "size", "ops", "ns/op", "allocs/op");
+    for (size = BENCH_FIRST_SIZE; size <= lastSize; size *= 10) {
+        for (distribution = 0; distribution < BENCH_DISTRIBUTIONS; distribution++) {
+            if (!benchHashTable(distribution, size) || !benchIntQueue(distribution, size)) {
+                printf("Out of memory.\n");
+                return 2;
+            }
+        }
+        if (!benchArrayList(size)) {
+            printf("Out of memory.\n");
+            return 2;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
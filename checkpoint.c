@@ -0,0 +1,175 @@
+/* ____________________________________________________________________________
+
+    Module checkpoint.c
+    This module saves the state of a running solve, so a long solve which
+    was stopped can continue from the last finished phase instead of from
+    zero flow. Checkpoint is a binary file with a header and the residual
+    capacities of all the arcs, which are the whole state between phases
+    of Dinics algorithm. The header holds hash of the solver graph (layout,
+    capacities, source and target), so a checkpoint is never applied to
+    another graph or query. The file is written under a temporary name and
+    renamed, so an interrupted write leaves the previous checkpoint intact.
+    Numbers are stored in the byte order of the machine.
+   ____________________________________________________________________________
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "checkpoint.h"
+#include "graph.h"
+
+#define CHECKPOINT_HASH_START 2166136261UL
+#define CHECKPOINT_HASH_PRIME 16777619UL
+
+typedef struct {
+    char magic[CHECKPOINT_MAGIC_SIZE];
+    unsigned long hash;
+    int flowType;
+    int nodeCount;
+    int arcCount;
+    int source;
+    int target;
+    int phaseCount;
+    flowValue maxFlow;
+} checkpointHeader;
+
+/* ____________________________________________________________________________
+
+    unsigned long checkpointHashWords(unsigned long hash, void *data,
+                                      size_t size)
+
+    Adds size bytes of the data to the hash (FNV-1a over 32 bit words,
+    size must be their multiple). Returns the new hash.
+   ____________________________________________________________________________
+*/
+static unsigned long checkpointHashWords(unsigned long hash, void *data, size_t size) {
+    size_t i;
+    unsigned int *words = data;
+
+    for (i = 0; i < size / sizeof(unsigned int); i++) {
+        hash ^= words[i];
+        hash *= CHECKPOINT_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+/* ____________________________________________________________________________
+
+    unsigned long checkpointHash(graph *graphPointer)
+
+    Returns hash of everything the flow depends on, the layout of the
+    arcs, their capacities, source and target.
+   ____________________________________________________________________________
+*/
+static unsigned long checkpointHash(graph *graphPointer) {
+    int counts[5];
+    unsigned long hash = CHECKPOINT_HASH_START;
+
+    counts[0] = graphPointer->flowType;
+    counts[1] = graphPointer->nodeCount;
+    counts[2] = graphPointer->arcCount;
+    counts[3] = graphPointer->source;
+    counts[4] = graphPointer->target;
+    hash = checkpointHashWords(hash, counts, sizeof(counts));
+    hash = checkpointHashWords(hash, graphPointer->firstArc, (graphPointer->nodeCount + 1) * sizeof(int));
+    hash = checkpointHashWords(hash, graphPointer->head, graphPointer->arcCount * sizeof(int));
+    hash = checkpointHashWords(hash, graphPointer->capacity,
+                               graphPointer->arcCount * graphFlowSize(graphPointer->flowType));
+
+    return hash;
+}
+
+/* ____________________________________________________________________________
+
+    int graphWriteCheckpoint(graph *graphPointer, char *fileName)
+
+    Writes flow of the graph between two phases of the solve into the
+    file. Returns SUCCESS or FAILURE if error occurred, the previous
+    content of the file is kept then.
+   ____________________________________________________________________________
+*/
+int graphWriteCheckpoint(graph *graphPointer, char *fileName) {
+    int written;
+    char *temporary;
+    size_t count;
+    checkpointHeader header;
+    FILE *file;
+
+    if (!graphPointer || !fileName) return FAILURE;
+
+    temporary = malloc(strlen(fileName) + sizeof(CHECKPOINT_SUFFIX));
+    if (!temporary) return FAILURE;
+    sprintf(temporary, "%s%s", fileName, CHECKPOINT_SUFFIX);
+
+    file = fopen(temporary, "wb");
+    if (!file) {
+        free(temporary);
+        return FAILURE;
+    }
+
+    /* padding of the header is written too, so it's cleared */
+    memset(&header, 0, sizeof(checkpointHeader));
+    memcpy(header.magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE);
+    header.hash = checkpointHash(graphPointer);
+    header.flowType = graphPointer->flowType;
+    header.nodeCount = graphPointer->nodeCount;
+    header.arcCount = graphPointer->arcCount;
+    header.source = graphPointer->source;
+    header.target = graphPointer->target;
+    header.phaseCount = graphPointer->phaseCount;
+    header.maxFlow = graphPointer->maxFlow;
+
+    count = graphPointer->arcCount + 1;
+    written = fwrite(&header, sizeof(checkpointHeader), 1, file) == 1
+              && fwrite(graphPointer->residual, graphFlowSize(graphPointer->flowType), count, file) == count;
+    written = fclose(file) == 0 && written;
+
+#ifndef __unix__
+    /* rename doesn't replace existing files everywhere */
+    if (written) remove(fileName);
+#endif
+    if (written) written = rename(temporary, fileName) == 0;
+    if (!written) remove(temporary);
+
+    free(temporary);
+    return written ? SUCCESS : FAILURE;
+}
+
+/* ____________________________________________________________________________
+
+    int graphReadCheckpoint(graph *graphPointer, char *fileName)
+
+    Sets flow of the graph from the checkpoint file, source and target of
+    the graph must be set already. Returns SUCCESS or FAILURE if the file
+    can't be read or if it belongs to another graph or query. Residual
+    capacities of the graph are overwritten only if the header matches.
+   ____________________________________________________________________________
+*/
+int graphReadCheckpoint(graph *graphPointer, char *fileName) {
+    int valid;
+    size_t count;
+    checkpointHeader header;
+    FILE *file;
+
+    if (!graphPointer || !fileName) return FAILURE;
+
+    file = fopen(fileName, "rb");
+    if (!file) return FAILURE;
+
+    valid = fread(&header, sizeof(checkpointHeader), 1, file) == 1
+            && memcmp(header.magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) == 0
+            && header.flowType == graphPointer->flowType && header.nodeCount == graphPointer->nodeCount
+            && header.arcCount == graphPointer->arcCount && header.source == graphPointer->source
+            && header.target == graphPointer->target && header.hash == checkpointHash(graphPointer);
+
+    count = graphPointer->arcCount + 1;
+    valid = valid && fread(graphPointer->residual, graphFlowSize(graphPointer->flowType), count, file) == count;
+    fclose(file);
+    if (!valid) return FAILURE;
+
+    graphPointer->maxFlow = header.maxFlow;
+    graphPointer->phaseCount = header.phaseCount;
+    graphPointer->touchedCount = -1;
+    return SUCCESS;
+}
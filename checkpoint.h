@@ -0,0 +1,20 @@
+#ifndef SEMESTRALKA_CHECKPOINT_H
+#define SEMESTRALKA_CHECKPOINT_H
+
+#include "structs.h"
+
+#define CHECKPOINT_MAGIC "FLOWCKP1"
+#define CHECKPOINT_MAGIC_SIZE 8
+#define CHECKPOINT_SUFFIX ".tmp"
+#define CHECKPOINT_DEFAULT_INTERVAL 600
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int graphWriteCheckpoint(graph *graphPointer, char *fileName);
+int graphReadCheckpoint(graph *graphPointer, char *fileName);
+
+#endif
@@ -0,0 +1,35 @@
+/* ____________________________________________________________________________
+
+    Module dynamicTree.c
+    This module contains blocking flow of Dinics algorithm which uses
+    dynamic trees (link-cut trees) of Sleator and Tarjan. Finding the
+    bottleneck of a path and augmenting it costs O(log V), so whole phase
+    costs O(E log V) instead of O(VE) of the depth first search. It pays
+    off on graphs with long augmenting paths. The code is written once in
+    dynamicTreeVariant.h for all the capacity types.
+   ____________________________________________________________________________
+*/
+
+#include <stdlib.h>
+#include <limits.h>
+#include <float.h>
+#include "graph.h"
+#include "dynamicTree.h"
+
+#define FLOW_TYPE int
+#define FLOW_FIELD integer
+#define FLOW_INF FLOW_INT_LIMIT
+#define FLOW_SUFFIX Int
+#include "dynamicTreeVariant.h"
+
+#define FLOW_TYPE long
+#define FLOW_FIELD integer
+#define FLOW_INF FLOW_LONG_LIMIT
+#define FLOW_SUFFIX Long
+#include "dynamicTreeVariant.h"
+
+#define FLOW_TYPE double
+#define FLOW_FIELD real
+#define FLOW_INF DBL_MAX
+#define FLOW_SUFFIX Real
+#include "dynamicTreeVariant.h"
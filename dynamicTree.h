@@ -0,0 +1,20 @@
+#ifndef SEMESTRALKA_DYNAMICTREE_H
+#define SEMESTRALKA_DYNAMICTREE_H
+
+#include "structs.h"
+
+/* node is root of its splay tree if it's not a child of its parent (path parent) */
+#define DYNAMIC_TREE_SPLAY_ROOT(tree, node) ((tree)->parent[node] == -1 \
+    || ((tree)->left[(tree)->parent[node]] != (node) && (tree)->right[(tree)->parent[node]] != (node)))
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int dynamicTreeBlockingFlowInt(graph *graphPointer);
+long dynamicTreeBlockingFlowLong(graph *graphPointer);
+double dynamicTreeBlockingFlowReal(graph *graphPointer);
+
+#endif
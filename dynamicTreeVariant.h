@@ -0,0 +1,408 @@
+/* ____________________________________________________________________________
+
+    Header dynamicTreeVariant.h
+    Blocking flow with dynamic trees written once for all capacity types.
+    The header has no include guard, dynamicTree.c includes it once for
+    every variant, the macros are the same as in graphVariant.h (FLOW_TYPE,
+    FLOW_FIELD, FLOW_INF, FLOW_SUFFIX) and they are undefined at the end.
+
+    Dynamic trees are link-cut trees made of splay trees. Every node of the
+    graph is a node of some tree, parentArc of the node is the arc to its
+    parent in the tree and value of the node is remaining capacity of the
+    arc. Splay trees keep the preferred paths ordered from the root of the
+    tree (left) to the deepest node (right), parent of the splay root is
+    the path parent. Lazy value is added to the whole splay subtree.
+   ____________________________________________________________________________
+*/
+
+#define FLOW_JOIN(name, suffix) name##suffix
+#define FLOW_EXPAND(name, suffix) FLOW_JOIN(name, suffix)
+#define FLOW_NAME(name) FLOW_EXPAND(name, FLOW_SUFFIX)
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct {
+    int *left;
+    int *right;
+    int *parent;
+    int *parentArc;
+    FLOW_TYPE *value;
+    FLOW_TYPE *minimum;
+    FLOW_TYPE *lazy;
+} FLOW_NAME(dynamicTree);
+
+/* ____________________________________________________________________________
+
+    void dynamicTreeApply(dynamicTree *tree, int node, FLOW_TYPE delta)
+
+    Adds delta to all values in the splay subtree of the node.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(dynamicTreeApply)(FLOW_NAME(dynamicTree) *tree, int node, FLOW_TYPE delta) {
+    if (node == -1) return;
+
+    tree->value[node] += delta;
+    tree->minimum[node] += delta;
+    tree->lazy[node] += delta;
+}
+
+/* ____________________________________________________________________________
+
+    void dynamicTreePush(dynamicTree *tree, int node)
+
+    Moves lazy value of the node to its children.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(dynamicTreePush)(FLOW_NAME(dynamicTree) *tree, int node) {
+    if (tree->lazy[node] == 0) return;
+
+    FLOW_NAME(dynamicTreeApply)(tree, tree->left[node], tree->lazy[node]);
+    FLOW_NAME(dynamicTreeApply)(tree, tree->right[node], tree->lazy[node]);
+    tree->lazy[node] = 0;
+}
+
+/* ____________________________________________________________________________
+
+    void dynamicTreeUpdate(dynamicTree *tree, int node)
+
+    Recomputes minimum of the splay subtree of the node.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(dynamicTreeUpdate)(FLOW_NAME(dynamicTree) *tree, int node) {
+    FLOW_TYPE minimum = tree->value[node];
+
+    if (tree->left[node] != -1) minimum = MIN(minimum, tree->minimum[tree->left[node]]);
+    if (tree->right[node] != -1) minimum = MIN(minimum, tree->minimum[tree->right[node]]);
+    tree->minimum[node] = minimum;
+}
+
+/* ____________________________________________________________________________
+
+    void dynamicTreeRotate(dynamicTree *tree, int node)
+
+    Rotates the node above its splay parent.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(dynamicTreeRotate)(FLOW_NAME(dynamicTree) *tree, int node) {
+    int parent = tree->parent[node];
+    int grandParent = tree->parent[parent];
+    int child;
+
+    if (tree->left[parent] == node) {
+        child = tree->right[node];
+        tree->left[parent] = child;
+        tree->right[node] = parent;
+    } else {
+        child = tree->left[node];
+        tree->right[parent] = child;
+        tree->left[node] = parent;
+    }
+    if (child != -1) tree->parent[child] = parent;
+
+    /* path parent of the splay root is kept by the new root */
+    if (grandParent != -1) {
+        if (tree->left[grandParent] == parent) tree->left[grandParent] = node;
+        else if (tree->right[grandParent] == parent) tree->right[grandParent] = node;
+    }
+    tree->parent[node] = grandParent;
+    tree->parent[parent] = node;
+
+    FLOW_NAME(dynamicTreeUpdate)(tree, parent);
+    FLOW_NAME(dynamicTreeUpdate)(tree, node);
+}
+
+/* ____________________________________________________________________________
+
+    void dynamicTreeSplay(dynamicTree *tree, int node, int *stack)
+
+    Moves the node to the root of its splay tree. Stack must have place for
+    all nodes of the graph.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(dynamicTreeSplay)(FLOW_NAME(dynamicTree) *tree, int node, int *stack) {
+    int top = 0;
+    int current = node;
+    int parent;
+    int grandParent;
+
+    /* lazy values are pushed down from the splay root to the node first */
+    stack[top++] = current;
+    while (!DYNAMIC_TREE_SPLAY_ROOT(tree, current)) {
+        current = tree->parent[current];
+        stack[top++] = current;
+    }
+    while (top > 0) FLOW_NAME(dynamicTreePush)(tree, stack[--top]);
+
+    while (!DYNAMIC_TREE_SPLAY_ROOT(tree, node)) {
+        parent = tree->parent[node];
+        if (!DYNAMIC_TREE_SPLAY_ROOT(tree, parent)) {
+            grandParent = tree->parent[parent];
+            if ((tree->left[grandParent] == parent) == (tree->left[parent] == node)) {
+                FLOW_NAME(dynamicTreeRotate)(tree, parent);
+            } else {
+                FLOW_NAME(dynamicTreeRotate)(tree, node);
+            }
+        }
+        FLOW_NAME(dynamicTreeRotate)(tree, node);
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void dynamicTreeAccess(dynamicTree *tree, int node, int *stack)
+
+    Makes the path from the root of the tree to the node preferred, the
+    node becomes root of the splay tree of the path and has no right child.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(dynamicTreeAccess)(FLOW_NAME(dynamicTree) *tree, int node, int *stack) {
+    int last = -1;
+    int current;
+
+    for (current = node; current != -1; current = tree->parent[current]) {
+        FLOW_NAME(dynamicTreeSplay)(tree, current, stack);
+        tree->right[current] = last;
+        FLOW_NAME(dynamicTreeUpdate)(tree, current);
+        last = current;
+    }
+    FLOW_NAME(dynamicTreeSplay)(tree, node, stack);
+}
+
+/* ____________________________________________________________________________
+
+    int dynamicTreeFindRoot(dynamicTree *tree, int node, int *stack)
+
+    Returns root of the tree which contains the node.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(dynamicTreeFindRoot)(FLOW_NAME(dynamicTree) *tree, int node, int *stack) {
+    FLOW_NAME(dynamicTreeAccess)(tree, node, stack);
+
+    while (tree->left[node] != -1) {
+        FLOW_NAME(dynamicTreePush)(tree, node);
+        node = tree->left[node];
+    }
+    FLOW_NAME(dynamicTreeSplay)(tree, node, stack);
+    return node;
+}
+
+/* ____________________________________________________________________________
+
+    int dynamicTreeFindMin(dynamicTree *tree, int node, int *stack)
+
+    Returns node with the smallest value on the path from the node to the
+    root of its tree, the one closest to the root is taken.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(dynamicTreeFindMin)(FLOW_NAME(dynamicTree) *tree, int node, int *stack) {
+    FLOW_TYPE rest;
+
+    FLOW_NAME(dynamicTreeAccess)(tree, node, stack);
+
+    /* minima are compared with each other, not with the minimum of the root, because
+       lazy values of doubles can be rounded differently on the way down */
+    while (1) {
+        FLOW_NAME(dynamicTreePush)(tree, node);
+        rest = tree->value[node];
+        if (tree->right[node] != -1) rest = MIN(rest, tree->minimum[tree->right[node]]);
+        if (tree->left[node] != -1 && tree->minimum[tree->left[node]] <= rest) {
+            node = tree->left[node];
+        } else if (tree->right[node] == -1 || tree->value[node] <= tree->minimum[tree->right[node]]) {
+            break;
+        } else {
+            node = tree->right[node];
+        }
+    }
+    FLOW_NAME(dynamicTreeSplay)(tree, node, stack);
+    return node;
+}
+
+/* ____________________________________________________________________________
+
+    void dynamicTreeCut(graph *graphPointer, dynamicTree *tree, int node,
+                        int *stack)
+
+    Cuts the node from its parent. Flow which was sent through the arc to
+    the parent is written to the residual capacities of the arc and of its
+    reverse arc.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(dynamicTreeCut)(graph *graphPointer, FLOW_NAME(dynamicTree) *tree, int node, int *stack) {
+    int arc = tree->parentArc[node];
+    FLOW_TYPE *residual = graphPointer->residual;
+
+    FLOW_NAME(dynamicTreeAccess)(tree, node, stack);
+    residual[REVERSE(arc)] += residual[arc] - tree->value[node];
+    residual[arc] = tree->value[node];
+
+    tree->parent[tree->left[node]] = -1;
+    tree->left[node] = -1;
+    tree->parentArc[node] = -1;
+    tree->value[node] = FLOW_INF;
+    FLOW_NAME(dynamicTreeUpdate)(tree, node);
+}
+
+/* ____________________________________________________________________________
+
+    void dynamicTreeLink(graphPointer, dynamicTree *tree, int node,
+                         int arc, int *stack)
+
+    Links the node (root of its tree) to the target of the arc, value of the
+    node is set to remaining capacity of the arc.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(dynamicTreeLink)(graph *graphPointer, FLOW_NAME(dynamicTree) *tree, int node, int arc,
+                                       int *stack) {
+    FLOW_TYPE *residual = graphPointer->residual;
+
+    FLOW_NAME(dynamicTreeAccess)(tree, node, stack);
+    tree->parentArc[node] = arc;
+    tree->value[node] = residual[arc];
+    FLOW_NAME(dynamicTreeUpdate)(tree, node);
+    tree->parent[node] = graphPointer->head[arc];
+}
+
+/* ____________________________________________________________________________
+
+    FLOW_TYPE dynamicTreeBlockingFlow(graph *graphPointer)
+
+    Finds blocking flow in the level graph made by graphBfs, next of the
+    nodes in visited list must be reset before. Only the nodes of the level
+    graph are initialised, so the phase doesn't cost O(V). Paths from the
+    source are grown by linking nodes along admissible arcs. When the path
+    reaches the target, the bottleneck is found and augmented in
+    logarithmic time and saturated arcs are cut. Nodes without admissible
+    arc are removed from the level graph (their level is set to -1) and
+    their children are cut. Returns the value of the flow, or -1 if memory
+    can't be allocated (the graph is not changed then).
+   ____________________________________________________________________________
+*/
+FLOW_TYPE FLOW_NAME(dynamicTreeBlockingFlow)(graph *graphPointer) {
+    int i;
+    int node;
+    int child;
+    int arc;
+    int bottleNeckNode;
+    int count = graphPointer->nodeCount;
+    int source = graphPointer->source;
+    int target = graphPointer->target;
+    int *stack;
+    FLOW_TYPE bottleNeck;
+    FLOW_TYPE flow = 0;
+    FLOW_TYPE *residual = graphPointer->residual;
+    graphNode *nodeList = graphPointer->nodeList;
+    FLOW_NAME(dynamicTree) tree;
+
+    tree.left = malloc(count * sizeof(int));
+    tree.right = malloc(count * sizeof(int));
+    tree.parent = malloc(count * sizeof(int));
+    tree.parentArc = malloc(count * sizeof(int));
+    tree.value = malloc(count * sizeof(FLOW_TYPE));
+    tree.minimum = malloc(count * sizeof(FLOW_TYPE));
+    tree.lazy = malloc(count * sizeof(FLOW_TYPE));
+    stack = malloc(count * sizeof(int));
+
+    /* only the nodes of the level graph can be linked, so only they are initialised */
+    count = graphPointer->visitedCount;
+    if (!tree.left || !tree.right || !tree.parent || !tree.parentArc || !tree.value || !tree.minimum || !tree.lazy
+        || !stack) {
+        flow = -1;
+        count = 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        node = graphPointer->visited[i];
+        tree.left[node] = -1;
+        tree.right[node] = -1;
+        tree.parent[node] = -1;
+        tree.parentArc[node] = -1;
+        tree.value[node] = FLOW_INF;
+        tree.minimum[node] = FLOW_INF;
+        tree.lazy[node] = 0;
+    }
+
+    while (count) {
+        node = FLOW_NAME(dynamicTreeFindRoot)(&tree, source, stack);
+
+        if (node == target) {
+            /* path from source to target is complete, it's augmented */
+            bottleNeckNode = FLOW_NAME(dynamicTreeFindMin)(&tree, source, stack);
+            bottleNeck = tree.value[bottleNeckNode];
+            FLOW_NAME(dynamicTreeAccess)(&tree, source, stack);
+            FLOW_NAME(dynamicTreeApply)(&tree, source, -bottleNeck);
+            flow += bottleNeck;
+
+            /* value of the root is not a capacity, it's set back */
+            FLOW_NAME(dynamicTreeAccess)(&tree, target, stack);
+            tree.value[target] = FLOW_INF;
+            FLOW_NAME(dynamicTreeUpdate)(&tree, target);
+
+            /* the bottleneck arc is saturated even if rounding of lazy values left a trace of
+               capacity in it, so every augmentation cuts at least one arc */
+            FLOW_NAME(dynamicTreeAccess)(&tree, bottleNeckNode, stack);
+            tree.value[bottleNeckNode] = 0;
+            FLOW_NAME(dynamicTreeUpdate)(&tree, bottleNeckNode);
+
+            /* saturated arcs are cut and never used again in this phase */
+            node = FLOW_NAME(dynamicTreeFindMin)(&tree, source, stack);
+            while (tree.value[node] <= 0) {
+                FLOW_NAME(dynamicTreeCut)(graphPointer, &tree, node, stack);
+                nodeList[node].next++;
+                node = FLOW_NAME(dynamicTreeFindMin)(&tree, source, stack);
+            }
+            continue;
+        }
+
+        /* the path is extended by the first admissible arc of its end */
+        for (; nodeList[node].next < graphPointer->firstArc[node + 1]; nodeList[node].next++) {
+            arc = graphPointer->arcs[nodeList[node].next];
+            if (residual[arc] > 0 && nodeList[graphPointer->head[arc]].level == nodeList[node].level + 1) break;
+        }
+
+        if (nodeList[node].next < graphPointer->firstArc[node + 1]) {
+            FLOW_NAME(dynamicTreeLink)(graphPointer, &tree, node, arc, stack);
+            continue;
+        }
+
+        /* the node is a dead end, so it's removed with all arcs into it */
+        if (node == source) break;
+        nodeList[node].level = -1;
+        for (i = graphPointer->firstArc[node]; i < graphPointer->firstArc[node + 1]; i++) {
+            child = graphPointer->head[graphPointer->arcs[i]];
+            /* linked nodes are never dead, other nodes may be outside of the level graph */
+            if (nodeList[child].level != -1 && tree.parentArc[child] == REVERSE(graphPointer->arcs[i])) {
+                FLOW_NAME(dynamicTreeCut)(graphPointer, &tree, child, stack);
+                nodeList[child].next++;
+            }
+        }
+    }
+
+    /* flow of the arcs which are still linked is written back */
+    for (i = 0; i < count; i++) {
+        node = graphPointer->visited[i];
+        if (tree.parentArc[node] != -1) FLOW_NAME(dynamicTreeCut)(graphPointer, &tree, node, stack);
+    }
+
+    free(tree.left);
+    free(tree.right);
+    free(tree.parent);
+    free(tree.parentArc);
+    free(tree.value);
+    free(tree.minimum);
+    free(tree.lazy);
+    free(stack);
+
+    return flow;
+}
+
+#undef FLOW_NAME
+#undef FLOW_EXPAND
+#undef FLOW_JOIN
+#undef FLOW_TYPE
+#undef FLOW_FIELD
+#undef FLOW_INF
+#undef FLOW_SUFFIX
@@ -1,9 +1,16 @@
 /* ____________________________________________________________________________
 
     Module graph.c
-    This module contains functions which work with graph struct and with
-    graphEdge struct. It also contains algorithm to find maximal network flow.
-    Dinics algorithm is used.
+    This module contains functions which work with graph struct. Nodes of
+    the graph are stored in array, arcs are stored as structure of arrays
+    (head and residual are used by the algorithm, capacity and members only
+    when the result is written). Arcs 2p and 2p + 1 are reverse to each
+    other, arcs of node i are listed in arcs array between firstArc[i] and
+    firstArc[i + 1]. Residual capacities and flows are int, long or double,
+    the type is picked by the capacities of the edges when the graph is
+    created. It also contains algorithm to find maximal network flow.
+    Dinics algorithm is used, it's written once in graphVariant.h for all
+    the types, blocking flow can be found by dynamic trees too.
    ____________________________________________________________________________
 */
 
@@ -11,358 +18,1524 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <float.h>
+#include <stdio.h>
 
 /* ____________________________________________________________________________
 
-    long remainingCapacity(graphEdge *edgePointer)
+    int graphEngineFromName(char *name)
 
-    Returns remaining capacity of the graphEdge. If graphEdge is NULL returns -1.
+    Returns engine described by name ("dinic", "dynamic" or "planar") or -1
+    if the name is unknown.
    ____________________________________________________________________________
 */
-long remainingCapacity(graphEdge *edgePointer) {
-    if (!edgePointer) return -1;
-    return edgePointer->capacity - edgePointer->flow;
+int graphEngineFromName(char *name) {
+    if (!name) return -1;
+
+    if (strcmp(name, "dinic") == 0) return ENGINE_DINIC;
+    if (strcmp(name, "dynamic") == 0) return ENGINE_DYNAMIC;
+    if (strcmp(name, "planar") == 0) return ENGINE_PLANAR;
+
+    return -1;
+}
+
+/* ____________________________________________________________________________
+
+    int compareNodePair(const void *a, const void *b)
+
+    Auxiliary function which compares two pairs of node indices. Necessary
+    for using qsort.
+   ____________________________________________________________________________
+*/
+static int compareNodePair(const void *a, const void *b) {
+    const int *first = a;
+    const int *second = b;
+
+    if (first[0] != second[0]) return first[0] - second[0];
+    return first[1] - second[1];
+}
+
+/* ____________________________________________________________________________
+
+    size_t graphFlowSize(int flowType)
+
+    Returns size of one residual capacity of the given flow type.
+   ____________________________________________________________________________
+*/
+size_t graphFlowSize(int flowType) {
+    switch (flowType) {
+        case FLOW_INT:
+            return sizeof(int);
+
+        case FLOW_LONG:
+            return sizeof(long);
+
+        default:
+            return sizeof(double);
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int graphPickFlowType(hashTable *edgesTable)
+
+    Picks the smallest flow type which can hold all flows of the graph.
+    Integer types are used only if all capacities are whole numbers and if
+    their total absolute value (undirected edges count twice) is at most
+    the limit of the type, so no residual capacity and no flow can
+    overflow. Double is used otherwise.
+   ____________________________________________________________________________
+*/
+static int graphPickFlowType(hashTable *edgesTable) {
+    int i;
+    int j;
+    double capacity;
+    double total = 0;
+    graphEdge *edgePointer;
+
+    for (i = 0; i < edgesTable->size; i++) {
+        for (j = 0; j < edgesTable->array[i]->filledItems; j++) {
+            edgePointer = arrayListGetPointer(edgesTable->array[i], j);
+            capacity = edgePointer->capacity < 0 ? -edgePointer->capacity : edgePointer->capacity;
+
+            /* the total is checked before the cast, so it can't overflow */
+            total += edgePointer->isUndirected ? 2 * capacity : capacity;
+            if (!(total <= (double) FLOW_LONG_LIMIT) || capacity != (double) (long) capacity) return FLOW_REAL;
+        }
+    }
+
+    return total <= (double) FLOW_INT_LIMIT ? FLOW_INT : FLOW_LONG;
 }
 
 /* ____________________________________________________________________________
 
-    void augment(graphEdge *edgePointer, long bottleNeck)
+    int *graphCollectPairs(hashTable *nodesTable, hashTable *edgesTable,
+                           int *pairCount)
 
-    Updates flow in the graphEdge and in the reverseEdge.
+    Finds all distinct pairs of nodes (by node->index) which are connected by
+    some edge in any direction. Every pair is stored as two indices, the
+    smaller one first, pairs are sorted. Loops and edges with unknown nodes
+    are skipped. Returns array of pairs or NULL if error occurred.
    ____________________________________________________________________________
 */
-void augment(graphEdge *edgePointer, long bottleNeck) {
-    if (!edgePointer || !edgePointer->reverseEdge) return;
+static int *graphCollectPairs(hashTable *nodesTable, hashTable *edgesTable, int *pairCount) {
+    int i;
+    int j;
+    int count = 0;
+    int *pairs;
+    graphNode *sourceNode;
+    graphNode *targetNode;
+    graphEdge *edgePointer;
+
+    pairs = malloc((edgesTable->filledItems + 1) * 2 * sizeof(int));
+    if (!pairs) return NULL;
+
+    for (i = 0; i < edgesTable->size; i++) {
+        for (j = 0; j < edgesTable->array[i]->filledItems; j++) {
+            edgePointer = arrayListGetPointer(edgesTable->array[i], j);
+            /* loops can't carry any flow from source to target */
+            if (edgePointer->source == edgePointer->target) continue;
+
+            sourceNode = hashTableGetElement(edgePointer->source, nodesTable);
+            targetNode = hashTableGetElement(edgePointer->target, nodesTable);
+            if (!sourceNode || !targetNode) continue;
+
+            pairs[2 * count] = MIN(sourceNode->index, targetNode->index);
+            pairs[2 * count + 1] = sourceNode->index + targetNode->index - pairs[2 * count];
+            count++;
+        }
+    }
 
-    edgePointer->flow += bottleNeck;
-    ((graphEdge *)edgePointer->reverseEdge)->flow -= bottleNeck;
+    qsort(pairs, count, 2 * sizeof(int), compareNodePair);
+
+    /* remove duplicates */
+    j = 0;
+    for (i = 0; i < count; i++) {
+        if (j > 0 && pairs[2 * i] == pairs[2 * (j - 1)] && pairs[2 * i + 1] == pairs[2 * (j - 1) + 1]) continue;
+        pairs[2 * j] = pairs[2 * i];
+        pairs[2 * j + 1] = pairs[2 * i + 1];
+        j++;
+    }
+
+    *pairCount = j;
+    return pairs;
 }
 
+/* ____________________________________________________________________________
+
+    int *graphFillAdjacency(int nodeCount, int *pairs, int pairCount,
+                            int *first, int storeArcs, mappedStore *store)
+
+    Fills first array (nodeCount + 1 items) and returns adjacency array,
+    items of node i are between indices first[i] and first[i + 1]. Both
+    directions of every pair are added. If storeArcs is set, arc indices
+    (2p from the smaller node of pair p, 2p + 1 from the bigger one) are
+    stored instead of neighbour indices. The adjacency array is allocated
+    in the store (in ordinary memory if it's NULL). Returns NULL if error
+    occurred.
+   ____________________________________________________________________________
+*/
+static int *graphFillAdjacency(int nodeCount, int *pairs, int pairCount, int *first, int storeArcs,
+                               mappedStore *store) {
+    int i;
+    int a;
+    int b;
+    int *adjacency;
+
+    adjacency = mappedStoreAlloc(store, (2 * pairCount + 1) * sizeof(int));
+    if (!adjacency) return NULL;
+
+    memset(first, 0, (nodeCount + 1) * sizeof(int));
+    for (i = 0; i < pairCount; i++) {
+        first[pairs[2 * i] + 1]++;
+        first[pairs[2 * i + 1] + 1]++;
+    }
+    for (i = 0; i < nodeCount; i++) first[i + 1] += first[i];
+
+    /* after the fill first[i] points to the end of items of the node i,
+       so the array is shifted back afterwards */
+    for (i = 0; i < pairCount; i++) {
+        a = pairs[2 * i];
+        b = pairs[2 * i + 1];
+        adjacency[first[a]++] = storeArcs ? 2 * i : b;
+        adjacency[first[b]++] = storeArcs ? 2 * i + 1 : a;
+    }
+    for (i = nodeCount; i > 0; i--) first[i] = first[i - 1];
+    first[0] = 0;
+
+    return adjacency;
+}
 
 /* ____________________________________________________________________________
 
-    graphEdge *createReverseEdge(uint from, uint to)
+    int graphCreateLayout(graph *graphPointer, graphNode **tableNodes,
+                          int *pairs, int pairCount, int order)
 
-    Tries to create graphEdge reverse with -1 id and zero capacity. If
-    it's successful, it returns pointer to new graphEdge, else it returns NULL.
+    Renumbers nodes by the order method and creates node and arc arrays of
+    the graph in the new order. Every pair of nodes gets one arc in each
+    direction, both arcs have zero capacity, graphAddEdge adds it. Pairs
+    are renumbered and sorted again. Arrays of the graph are allocated in
+    its store. Returns boolean value if it was successful.
    ____________________________________________________________________________
 */
-graphEdge *createReverseEdge(int from, int to) {
-    graphEdge *temp = calloc(1, sizeof(graphEdge));
-    if (!temp) return NULL;
+static int graphCreateLayout(graph *graphPointer, graphNode **tableNodes, int *pairs, int pairCount, int order) {
+    int i;
+    int a;
+    int b;
+    int count = graphPointer->nodeCount;
+    int *first;
+    int *neighbours;
+    int *nodeOrder;
+    int *newIndex;
+
+    first = mappedStoreAlloc(graphPointer->store, (count + 1) * sizeof(int));
+    if (!first) return FAILURE;
+
+    neighbours = graphFillAdjacency(count, pairs, pairCount, first, 0, NULL);
+    if (!neighbours) {
+        mappedStoreFree(graphPointer->store, first);
+        return FAILURE;
+    }
 
-    temp->source = from;
-    temp->target = to;
-    temp->capacity = 0;
-    temp->id = -1;
-    return temp;
+    nodeOrder = orderNodes(order, count, first, neighbours, tableNodes);
+    free(neighbours);
+    newIndex = malloc((count + 1) * sizeof(int));
+    if (!nodeOrder || !newIndex) {
+        mappedStoreFree(graphPointer->store, first);
+        free(nodeOrder);
+        free(newIndex);
+        return FAILURE;
+    }
+
+    for (i = 0; i < count; i++) {
+        newIndex[nodeOrder[i]] = i;
+        graphPointer->nodeList[i].id = tableNodes[nodeOrder[i]]->id;
+        graphPointer->nodeList[i].wkt = tableNodes[nodeOrder[i]]->wkt;
+        graphPointer->nodeList[i].index = i;
+        graphPointer->nodeList[i].level = -1;
+    }
+    for (i = 0; i < count; i++) tableNodes[i]->index = newIndex[i];
+
+    /* arcs of the pairs follow the new order of nodes too */
+    for (i = 0; i < pairCount; i++) {
+        a = newIndex[pairs[2 * i]];
+        b = newIndex[pairs[2 * i + 1]];
+        pairs[2 * i] = MIN(a, b);
+        pairs[2 * i + 1] = a + b - pairs[2 * i];
+    }
+    qsort(pairs, pairCount, 2 * sizeof(int), compareNodePair);
+    free(nodeOrder);
+    free(newIndex);
+
+    graphPointer->arcCount = 2 * pairCount;
+    graphPointer->firstArc = first;
+    graphPointer->arcs = graphFillAdjacency(count, pairs, pairCount, first, 1, graphPointer->store);
+    graphPointer->head = mappedStoreAlloc(graphPointer->store, (2 * pairCount + 1) * sizeof(int));
+    graphPointer->residual = mappedStoreAlloc(graphPointer->store,
+                                              (2 * pairCount + 1) * graphFlowSize(graphPointer->flowType));
+    graphPointer->capacity = mappedStoreAlloc(graphPointer->store,
+                                              (2 * pairCount + 1) * graphFlowSize(graphPointer->flowType));
+    if (!graphPointer->arcs || !graphPointer->head || !graphPointer->residual || !graphPointer->capacity) {
+        return FAILURE;
+    }
+
+    for (i = 0; i < pairCount; i++) {
+        graphPointer->head[2 * i] = pairs[2 * i + 1];
+        graphPointer->head[2 * i + 1] = pairs[2 * i];
+    }
+
+    return SUCCESS;
 }
 
 /* ____________________________________________________________________________
 
-    graph *createNewGraph(arrayList *nodesList, arrayList *edgesTable)
+    int graphFillMembers(graph *graphPointer, hashTable *edgesTable)
 
-    Creates new graph from arrayLists which contain graphNodes and graphEdges.
-    Sets up everything which is needed to run maximal flow algorithm. Returns
-    pointer to the graph or NULL if error occurred.
+    Adds capacity of every loaded edge to its arc (see graphAddEdge) and
+    creates member arrays, members of arc e are in memberList between
+    firstMember[e] and firstMember[e + 1]. Returns boolean value if it was
+    successful.
    ____________________________________________________________________________
 */
-graph *createNewGraph(hashTable *nodesTable, hashTable *edgesTable) {
+static int graphFillMembers(graph *graphPointer, hashTable *edgesTable) {
     int i;
     int j;
+    int count = 0;
+    int *edgeArcs;
+    int *first;
     graphEdge *edgePointer;
+
+    edgeArcs = malloc((edgesTable->filledItems + 1) * sizeof(int));
+    first = mappedStoreAlloc(graphPointer->store, (graphPointer->arcCount + 1) * sizeof(int));
+    graphPointer->firstMember = first;
+    if (!edgeArcs || !first) {
+        free(edgeArcs);
+        return FAILURE;
+    }
+
+    for (i = 0; i < edgesTable->size; i++) {
+        for (j = 0; j < edgesTable->array[i]->filledItems; j++) {
+            edgePointer = arrayListGetPointer(edgesTable->array[i], j);
+            edgeArcs[count] = graphAddEdge(edgePointer, graphPointer);
+            if (edgeArcs[count] != -1) first[edgeArcs[count] + 1]++;
+            count++;
+        }
+    }
+    for (i = 0; i < graphPointer->arcCount; i++) first[i + 1] += first[i];
+
+    graphPointer->memberList = mappedStoreAlloc(graphPointer->store,
+                                                (first[graphPointer->arcCount] + 1) * sizeof(graphEdge *));
+    if (!graphPointer->memberList) {
+        free(edgeArcs);
+        return FAILURE;
+    }
+
+    /* members are filled in the same order as they were counted */
+    count = 0;
+    for (i = 0; i < edgesTable->size; i++) {
+        for (j = 0; j < edgesTable->array[i]->filledItems; j++) {
+            if (edgeArcs[count] != -1) {
+                graphPointer->memberList[first[edgeArcs[count]]++] = arrayListGetPointer(edgesTable->array[i], j);
+            }
+            count++;
+        }
+    }
+    for (i = graphPointer->arcCount; i > 0; i--) first[i] = first[i - 1];
+    first[0] = 0;
+
+    free(edgeArcs);
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    mappedStore *graphNodeStore(graph *graphPointer)
+
+    Returns store of the node arrays. They are read randomly by the
+    search, so they are kept in huge pages with the arcs, but not in the
+    files of a mapped store (they stay in ordinary memory then).
+   ____________________________________________________________________________
+*/
+static mappedStore *graphNodeStore(graph *graphPointer) {
+    return MAPPED_FROM_FILES(graphPointer->store) ? NULL : graphPointer->store;
+}
+
+/* ____________________________________________________________________________
+
+    void graphAdviseArrays(graph *graphPointer)
+
+    Tells the store of the graph how its arrays are accessed. The solve
+    reads arcs of every level of the search in the order of the layout
+    (see graphBfs), the output reads the members in order too.
+   ____________________________________________________________________________
+*/
+static void graphAdviseArrays(graph *graphPointer) {
+    mappedStore *store = graphPointer->store;
+
+    mappedStoreAdvise(store, graphPointer->firstArc, MAPPED_SEQUENTIAL);
+    mappedStoreAdvise(store, graphPointer->arcs, MAPPED_SEQUENTIAL);
+    mappedStoreAdvise(store, graphPointer->head, MAPPED_SEQUENTIAL);
+    mappedStoreAdvise(store, graphPointer->residual, MAPPED_SEQUENTIAL);
+    mappedStoreAdvise(store, graphPointer->capacity, MAPPED_SEQUENTIAL);
+    mappedStoreAdvise(store, graphPointer->firstMember, MAPPED_SEQUENTIAL);
+    mappedStoreAdvise(store, graphPointer->memberList, MAPPED_SEQUENTIAL);
+}
+
+/* ____________________________________________________________________________
+
+    graph *createNewGraph(hashTable *nodesTable, hashTable *edgesTable,
+                          int order)
+
+    Creates new graph from hashTables which contain graphNodes and
+    graphEdges. Only edges which have both nodes in nodesTable are used, so
+    the graph can be built over pruned nodes. Nodes get new indices by the
+    order method (see order.h), node->index of the nodes in nodesTable is
+    updated. Nodes and arcs of the graph are stored in arrays in this
+    order. Loaded edges become members of the arcs and nodes of the graph
+    share wkt of the table nodes, so they must live as long as the graph.
+    Flow type of the graph is picked by the capacities of the edges (see
+    graphPickFlowType). Sets up everything which is needed to run maximal
+    flow algorithm. Returns pointer to the graph or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+graph *createNewGraph(hashTable *nodesTable, hashTable *edgesTable, int order) {
+    return createMappedGraph(nodesTable, edgesTable, order, NULL);
+}
+
+/* ____________________________________________________________________________
+
+    graph *createMappedGraph(hashTable *nodesTable, hashTable *edgesTable,
+                             int order, mappedStore *store)
+
+    Creates new graph like createNewGraph, but arc arrays (adjacency,
+    capacities, residual capacities and members) are allocated in the
+    store (see mapped.c), so they can be bigger than the memory. The graph
+    takes over the store, it's freed with the graph or right away if the
+    graph can't be created. Store can be NULL. Returns pointer to the graph
+    or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+graph *createMappedGraph(hashTable *nodesTable, hashTable *edgesTable, int order, mappedStore *store) {
+    int i;
+    int j;
+    int count = 0;
+    int pairCount;
+    int *pairs;
+    graphNode **tableNodes;
     graph *graphPointer;
+    mappedStore *nodeStore;
 
     if (!nodesTable || !edgesTable || (nodesTable->itemSize != sizeof(graphNode))
-        || (edgesTable->itemSize != sizeof(graphEdge))) return NULL;
+        || (edgesTable->itemSize != sizeof(graphEdge)) || nodesTable->filledItems == 0) {
+        freeMappedStore(&store);
+        return NULL;
+    }
 
     graphPointer = calloc(1, sizeof(graph));
-    if (!graphPointer) return NULL;
-
-    graphPointer->nodes = nodesTable;
-    graphPointer->edges = createHashTable(nodesTable->size, sizeof(graphEdge));
-    if (!graphPointer->edges) {
-        freeNewGraph(&graphPointer);
+    if (!graphPointer) {
+        freeMappedStore(&store);
         return NULL;
     }
 
-    graphPointer->maxFlow = 0;
+    graphPointer->store = store;
+    graphPointer->nodes = nodesTable;
+    graphPointer->nodeCount = nodesTable->filledItems;
+    graphPointer->flowType = graphPickFlowType(edgesTable);
     graphPointer->source = -1;
     graphPointer->target = -1;
 
-    for (i = 0; i < edgesTable->size; i++) {
-        for (j = 0; j < edgesTable->array[i]->filledItems; j++) {
-            edgePointer = arrayListGetPointer(edgesTable->array[i], j);
-            if (edgePointer) {
-                graphAddEdge(edgePointer, graphPointer);
-            }
+    nodeStore = graphNodeStore(graphPointer);
+    graphPointer->nodeList = mappedStoreAlloc(nodeStore, graphPointer->nodeCount * sizeof(graphNode));
+    graphPointer->visited = mappedStoreAlloc(nodeStore, (graphPointer->nodeCount + 1) * sizeof(int));
+    graphPointer->touched = mappedStoreAlloc(nodeStore, graphPointer->nodeCount * sizeof(int));
+    graphPointer->isTouched = mappedStoreAlloc(nodeStore, graphPointer->nodeCount * sizeof(char));
+    tableNodes = malloc(graphPointer->nodeCount * sizeof(graphNode *));
+    if (!graphPointer->nodeList || !graphPointer->visited || !graphPointer->touched || !graphPointer->isTouched
+        || !tableNodes) {
+        free(tableNodes);
+        freeNewGraph(&graphPointer);
+        return NULL;
+    }
+
+    for (i = 0; i < nodesTable->size; i++) {
+        for (j = 0; j < nodesTable->array[i]->filledItems; j++) {
+            tableNodes[count] = arrayListGetPointer(nodesTable->array[i], j);
+            tableNodes[count]->index = count;
+            count++;
         }
     }
 
-    /* all edges are sorted, because in hashtable there can be edges with different source
-       nodes on the same place */
-    for (i = 0; i < graphPointer->edges->size; i++) {
-        sortArrayList(graphPointer->edges->array[i]);
+    pairs = graphCollectPairs(nodesTable, edgesTable, &pairCount);
+    if (!pairs || !graphCreateLayout(graphPointer, tableNodes, pairs, pairCount, order)
+        || !graphFillMembers(graphPointer, edgesTable)) {
+        free(pairs);
+        free(tableNodes);
+        freeNewGraph(&graphPointer);
+        return NULL;
     }
+    free(pairs);
+    free(tableNodes);
 
+    graphAdviseArrays(graphPointer);
     return graphPointer;
 }
 
 /* ____________________________________________________________________________
 
-    void graphAddEdge(graphEdge *oldEdge, graph *graphPointer)
+    double graphValue(void *values, int flowType, int index)
+
+    Returns item of the array of the flow type as double.
+   ____________________________________________________________________________
+*/
+static double graphValue(void *values, int flowType, int index) {
+    switch (flowType) {
+        case FLOW_INT:
+            return ((int *) values)[index];
+
+        case FLOW_LONG:
+            return (double) ((long *) values)[index];
+
+        default:
+            return ((double *) values)[index];
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void graphSetValue(void *values, int flowType, int index, double value)
+
+    Sets item of the array of the flow type to the value.
+   ____________________________________________________________________________
+*/
+static void graphSetValue(void *values, int flowType, int index, double value) {
+    switch (flowType) {
+        case FLOW_INT:
+            ((int *) values)[index] = (int) value;
+            break;
+
+        case FLOW_LONG:
+            ((long *) values)[index] = (long) value;
+            break;
+
+        default:
+            ((double *) values)[index] = value;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    double graphTerminalLimit(graph *graphPointer, int node,
+                              graphTerminal *terminal, int isSource)
+
+    Returns capacity of the virtual arc of the terminal. Terminal without
+    limit, or with a limit which isn't smaller than the total capacity of
+    the arcs out of the node (into the node for targets), gets the total
+    plus one. It never limits the flow and it is bigger than the cut of
+    the real arcs of the node, so the minimal cut never lies on the arc.
+    It is clamped to the flow type, so the flows still fit into it.
+   ____________________________________________________________________________
+*/
+static double graphTerminalLimit(graph *graphPointer, int node, graphTerminal *terminal, int isSource) {
+    int i;
+    int arc;
+    double total = 0;
+
+    for (i = graphPointer->firstArc[node]; i < graphPointer->firstArc[node + 1]; i++) {
+        arc = isSource ? graphPointer->arcs[i] : REVERSE(graphPointer->arcs[i]);
+        total += graphValue(graphPointer->capacity, graphPointer->flowType, arc);
+    }
+
+    if (terminal->limit > 0 && terminal->limit < total) return terminal->limit;
+
+    total += 1;
+    if (graphPointer->flowType == FLOW_INT && total > (double) FLOW_INT_LIMIT) return (double) FLOW_INT_LIMIT;
+    if (graphPointer->flowType == FLOW_LONG && total > (double) FLOW_LONG_LIMIT) return (double) FLOW_LONG_LIMIT;
+    return total;
+}
+
+/* ____________________________________________________________________________
+
+    int graphAddTerminals(graph *graphPointer, graphTerminal *sources,
+                          int sourceCount, graphTerminal *targets,
+                          int targetCount)
+
+    Adds virtual super source and super target to the end of the nodes of
+    the graph (before the solve), super source gets an arc to every
+    source and every target gets an arc to super target, capacities of
+    the arcs are limits of the terminals (see graphTerminalLimit). The
+    arcs have no member edges, so they never appear in the output. The
+    arc arrays are created again with the virtual arcs at the end, the
+    flow type changes to double if some limit is fractional. Returns
+    FAILURE if some terminal is not in the graph or if error occurred,
+    the graph is not changed then.
+   ____________________________________________________________________________
+*/
+int graphAddTerminals(graph *graphPointer, graphTerminal *sources, int sourceCount, graphTerminal *targets,
+                      int targetCount) {
+    int i;
+    int arc;
+    int node;
+    int nodeCount;
+    int arcCount;
+    int flowType;
+    int terminalCount = sourceCount + targetCount;
+    int *terminalNodes;
+    int *fill;
+    int *first;
+    int *arcs;
+    int *head;
+    int *firstMember;
+    int *visited;
+    int *touched;
+    char *isTouched;
+    void *capacity;
+    void *residual;
+    double *limits;
+    graphNode *nodeList;
+    graphNode *nodePointer;
+    mappedStore *nodeStore;
+
+    if (!graphPointer || !sources || !targets || sourceCount < 1 || targetCount < 1
+        || graphPointer->terminalCount) return FAILURE;
+
+    terminalNodes = malloc(terminalCount * sizeof(int));
+    limits = malloc(terminalCount * sizeof(double));
+    if (!terminalNodes || !limits) {
+        free(terminalNodes);
+        free(limits);
+        return FAILURE;
+    }
+
+    /* sources go first, their virtual arcs are the first too */
+    flowType = graphPointer->flowType;
+    for (i = 0; i < terminalCount; i++) {
+        nodePointer = hashTableGetElement(i < sourceCount ? sources[i].id : targets[i - sourceCount].id,
+                                          graphPointer->nodes);
+        if (!nodePointer) {
+            free(terminalNodes);
+            free(limits);
+            return FAILURE;
+        }
+        terminalNodes[i] = nodePointer->index;
+        limits[i] = graphTerminalLimit(graphPointer, nodePointer->index,
+                                       i < sourceCount ? &sources[i] : &targets[i - sourceCount], i < sourceCount);
+        if (limits[i] != (double) (long) limits[i]) flowType = FLOW_REAL;
+    }
+
+    nodeCount = graphPointer->nodeCount + 2;
+    arcCount = graphPointer->arcCount + 2 * terminalCount;
+
+    nodeStore = graphNodeStore(graphPointer);
+    nodeList = mappedStoreAlloc(nodeStore, nodeCount * sizeof(graphNode));
+    visited = mappedStoreAlloc(nodeStore, (nodeCount + 1) * sizeof(int));
+    touched = mappedStoreAlloc(nodeStore, nodeCount * sizeof(int));
+    isTouched = mappedStoreAlloc(nodeStore, nodeCount * sizeof(char));
+    fill = malloc(nodeCount * sizeof(int));
+    first = mappedStoreAlloc(graphPointer->store, (nodeCount + 1) * sizeof(int));
+    arcs = mappedStoreAlloc(graphPointer->store, (arcCount + 1) * sizeof(int));
+    head = mappedStoreAlloc(graphPointer->store, (arcCount + 1) * sizeof(int));
+    firstMember = mappedStoreAlloc(graphPointer->store, (arcCount + 1) * sizeof(int));
+    capacity = mappedStoreAlloc(graphPointer->store, (arcCount + 1) * graphFlowSize(flowType));
+    residual = mappedStoreAlloc(graphPointer->store, (arcCount + 1) * graphFlowSize(flowType));
+    if (!nodeList || !visited || !touched || !isTouched || !fill || !first || !arcs || !head || !firstMember
+        || !capacity || !residual) {
+        mappedStoreFree(graphPointer->store, residual);
+        mappedStoreFree(graphPointer->store, capacity);
+        mappedStoreFree(graphPointer->store, firstMember);
+        mappedStoreFree(graphPointer->store, head);
+        mappedStoreFree(graphPointer->store, arcs);
+        mappedStoreFree(graphPointer->store, first);
+        mappedStoreFree(nodeStore, isTouched);
+        mappedStoreFree(nodeStore, touched);
+        mappedStoreFree(nodeStore, visited);
+        mappedStoreFree(nodeStore, nodeList);
+        free(fill);
+        free(terminalNodes);
+        free(limits);
+        return FAILURE;
+    }
+
+    /* old arcs of every node go first, then its virtual arcs */
+    first[0] = 0;
+    for (node = 0; node < graphPointer->nodeCount; node++) {
+        first[node + 1] = graphPointer->firstArc[node + 1] - graphPointer->firstArc[node];
+    }
+    for (i = 0; i < terminalCount; i++) first[terminalNodes[i] + 1]++;
+    first[nodeCount - 1] = sourceCount;
+    first[nodeCount] = targetCount;
+    for (node = 0; node < nodeCount; node++) first[node + 1] += first[node];
+
+    for (node = 0; node < graphPointer->nodeCount; node++) {
+        fill[node] = first[node];
+        for (i = graphPointer->firstArc[node]; i < graphPointer->firstArc[node + 1]; i++) {
+            arcs[fill[node]++] = graphPointer->arcs[i];
+        }
+    }
+    fill[nodeCount - 2] = first[nodeCount - 2];
+    fill[nodeCount - 1] = first[nodeCount - 1];
+
+    for (arc = 0; arc < graphPointer->arcCount; arc++) {
+        head[arc] = graphPointer->head[arc];
+        graphSetValue(capacity, flowType, arc, graphValue(graphPointer->capacity, graphPointer->flowType, arc));
+        graphSetValue(residual, flowType, arc, graphValue(graphPointer->residual, graphPointer->flowType, arc));
+    }
+    for (arc = 0; arc <= graphPointer->arcCount; arc++) firstMember[arc] = graphPointer->firstMember[arc];
+    for (; arc <= arcCount; arc++) firstMember[arc] = graphPointer->firstMember[graphPointer->arcCount];
+
+    /* super source leads to the sources, targets lead to super target, reverse arcs have no capacity */
+    for (i = 0; i < terminalCount; i++) {
+        arc = graphPointer->arcCount + 2 * i;
+        node = i < sourceCount ? nodeCount - 2 : terminalNodes[i];
+        head[arc] = i < sourceCount ? terminalNodes[i] : nodeCount - 1;
+        head[REVERSE(arc)] = node;
+        arcs[fill[node]++] = arc;
+        arcs[fill[head[arc]]++] = REVERSE(arc);
+
+        graphSetValue(capacity, flowType, arc, limits[i]);
+        graphSetValue(residual, flowType, arc, limits[i]);
+        graphSetValue(capacity, flowType, REVERSE(arc), 0);
+        graphSetValue(residual, flowType, REVERSE(arc), 0);
+    }
+    graphSetValue(capacity, flowType, arcCount, 0);
+    graphSetValue(residual, flowType, arcCount, 0);
+
+    memcpy(nodeList, graphPointer->nodeList, graphPointer->nodeCount * sizeof(graphNode));
+    memcpy(isTouched, graphPointer->isTouched, graphPointer->nodeCount);
+    for (node = graphPointer->nodeCount; node < nodeCount; node++) {
+        memset(&nodeList[node], 0, sizeof(graphNode));
+        nodeList[node].id = -1;
+        nodeList[node].index = node;
+        nodeList[node].level = -1;
+        isTouched[node] = 0;
+    }
+
+    mappedStoreFree(graphPointer->store, graphPointer->residual);
+    mappedStoreFree(graphPointer->store, graphPointer->capacity);
+    mappedStoreFree(graphPointer->store, graphPointer->firstMember);
+    mappedStoreFree(graphPointer->store, graphPointer->head);
+    mappedStoreFree(graphPointer->store, graphPointer->arcs);
+    mappedStoreFree(graphPointer->store, graphPointer->firstArc);
+    mappedStoreFree(nodeStore, graphPointer->isTouched);
+    mappedStoreFree(nodeStore, graphPointer->touched);
+    mappedStoreFree(nodeStore, graphPointer->visited);
+    mappedStoreFree(nodeStore, graphPointer->nodeList);
+    graphPointer->nodeList = nodeList;
+    graphPointer->visited = visited;
+    graphPointer->touched = touched;
+    graphPointer->isTouched = isTouched;
+    graphPointer->firstArc = first;
+    graphPointer->arcs = arcs;
+    graphPointer->head = head;
+    graphPointer->firstMember = firstMember;
+    graphPointer->capacity = capacity;
+    graphPointer->residual = residual;
+    graphPointer->flowType = flowType;
+    graphPointer->nodeCount = nodeCount;
+    graphPointer->arcCount = arcCount;
+    graphPointer->terminalCount = terminalCount;
+    graphPointer->touchedCount = -1;
+    graphAdviseArrays(graphPointer);
+
+    free(fill);
+    free(terminalNodes);
+    free(limits);
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int graphFindArc(int from, int to, graph *graphPointer)
+
+    Returns index of the arc which leads from node with index from to node
+    with index to, or -1 if there is no such arc.
+   ____________________________________________________________________________
+*/
+int graphFindArc(int from, int to, graph *graphPointer) {
+    int i;
+
+    if (!graphPointer || from < 0 || from >= graphPointer->nodeCount) return -1;
+
+    for (i = graphPointer->firstArc[from]; i < graphPointer->firstArc[from + 1]; i++) {
+        if (graphPointer->head[graphPointer->arcs[i]] == to) return graphPointer->arcs[i];
+    }
+
+    return -1;
+}
+
+/* ____________________________________________________________________________
+
+    void graphAddCapacity(graph *graphPointer, int arc, double capacity)
+
+    Adds capacity to the capacity and to the residual capacity of the arc.
+   ____________________________________________________________________________
+*/
+static void graphAddCapacity(graph *graphPointer, int arc, double capacity) {
+    switch (graphPointer->flowType) {
+        case FLOW_INT:
+            ((int *) graphPointer->capacity)[arc] += (int) capacity;
+            ((int *) graphPointer->residual)[arc] += (int) capacity;
+            break;
+
+        case FLOW_LONG:
+            ((long *) graphPointer->capacity)[arc] += (long) capacity;
+            ((long *) graphPointer->residual)[arc] += (long) capacity;
+            break;
+
+        default:
+            ((double *) graphPointer->capacity)[arc] += capacity;
+            ((double *) graphPointer->residual)[arc] += capacity;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void graphSetCapacity(graph *graphPointer, int arc, double capacity)
+
+    Sets capacity of the arc, residual capacity is changed so that the
+    flow of the arc stays the same.
+   ____________________________________________________________________________
+*/
+static void graphSetCapacity(graph *graphPointer, int arc, double capacity) {
+    switch (graphPointer->flowType) {
+        case FLOW_INT:
+            ((int *) graphPointer->residual)[arc] = (int) capacity - (((int *) graphPointer->capacity)[arc]
+                                                                     - ((int *) graphPointer->residual)[arc]);
+            ((int *) graphPointer->capacity)[arc] = (int) capacity;
+            break;
+
+        case FLOW_LONG:
+            ((long *) graphPointer->residual)[arc] = (long) capacity - (((long *) graphPointer->capacity)[arc]
+                                                                       - ((long *) graphPointer->residual)[arc]);
+            ((long *) graphPointer->capacity)[arc] = (long) capacity;
+            break;
+
+        default:
+            ((double *) graphPointer->residual)[arc] = capacity - (((double *) graphPointer->capacity)[arc]
+                                                                   - ((double *) graphPointer->residual)[arc]);
+            ((double *) graphPointer->capacity)[arc] = capacity;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int graphAddEdge(graphEdge *oldEdge, graph *graphPointer)
+
+    Adds capacity of oldEdge to the arc between its nodes, capacity of
+    undirected edge is added to the reverse arc too. All parallel and
+    antiparallel edges share one pair of arcs, which is created by
+    createNewGraph. Edges with nodes outside of the graph and loops are
+    ignored. Returns index of the arc or -1 if the edge was ignored.
+   ____________________________________________________________________________
+*/
+int graphAddEdge(graphEdge *oldEdge, graph *graphPointer) {
+    int arc;
+    graphNode *sourceNode;
+    graphNode *targetNode;
+    if (!oldEdge || !graphPointer) return -1;
+
+    sourceNode = hashTableGetElement(oldEdge->source, graphPointer->nodes);
+    targetNode = hashTableGetElement(oldEdge->target, graphPointer->nodes);
+    if (!sourceNode || !targetNode || sourceNode == targetNode) return -1;
+
+    arc = graphFindArc(sourceNode->index, targetNode->index, graphPointer);
+    if (arc == -1) return -1;
+
+    graphAddCapacity(graphPointer, arc, oldEdge->capacity);
+    if (oldEdge->isUndirected) graphAddCapacity(graphPointer, REVERSE(arc), oldEdge->capacity);
+    return arc;
+}
+
+/* ____________________________________________________________________________
+
+    double graphArcFlow(graph *graphPointer, int arc)
+
+    Returns flow of the arc (capacity minus residual capacity), the flow is
+    negative if it goes in the opposite direction.
+   ____________________________________________________________________________
+*/
+double graphArcFlow(graph *graphPointer, int arc) {
+    switch (graphPointer->flowType) {
+        case FLOW_INT:
+            return ((int *) graphPointer->capacity)[arc] - ((int *) graphPointer->residual)[arc];
+
+        case FLOW_LONG:
+            return (double) (((long *) graphPointer->capacity)[arc] - ((long *) graphPointer->residual)[arc]);
+
+        default:
+            return ((double *) graphPointer->capacity)[arc] - ((double *) graphPointer->residual)[arc];
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int graphUsesEdge(graph *graphPointer, graphEdge *edgePointer)
 
-    Creates newEdge, same as oldEdge, creates reverse edge to the newEdge and
-    adds both in the graph.
+    Returns boolean value if capacity of the edge is part of the graph,
+    invalid edges are left out while the graph is valid only (see
+    graphUseInvalid).
    ____________________________________________________________________________
 */
-void graphAddEdge(graphEdge *oldEdge, graph *graphPointer) {
-    graphEdge *newEdge;
-    graphEdge *reverseEdge;
-    if (!oldEdge || !graphPointer) return;
-    newEdge = calloc(1, sizeof (graphEdge));
-    if (!newEdge) return;
+int graphUsesEdge(graph *graphPointer, graphEdge *edgePointer) {
+    return !graphPointer->validOnly || edgePointer->isValid == 'Y';
+}
+
+/* ____________________________________________________________________________
 
-    newEdge->id = oldEdge->id;
-    newEdge->source = oldEdge->source;
-    newEdge->target = oldEdge->target;
-    newEdge->capacity = oldEdge->capacity;
-    newEdge->isValid = oldEdge->isValid;
-    newEdge->wkt = calloc(1, strlen(oldEdge->wkt) + 1);
-    strncpy(newEdge->wkt, oldEdge->wkt, strlen(oldEdge->wkt));
+    void graphUseInvalid(graph *graphPointer, int use)
 
-    reverseEdge = createReverseEdge(newEdge->target, newEdge->source);
-    if (!reverseEdge) return;
+    Switches capacities of invalid edges on (use is set) or off, capacities
+    of the arcs are summed from their members again. Flow of the graph is
+    kept, so switching them on after the solve leaves feasible flow which
+    can be augmented further by graphSolve. Flow of the arcs must fit into
+    their capacities, when they are switched off.
+   ____________________________________________________________________________
+*/
+void graphUseInvalid(graph *graphPointer, int use) {
+    int i;
+    int k;
+    int arc;
+    double capacity;
+    graphEdge *memberPointer;
+
+    if (!graphPointer) return;
+
+    /* virtual arcs of the terminals are at the end, they have no members */
+    graphPointer->validOnly = !use;
+    for (i = 0; i < graphPointer->arcCount - 2 * graphPointer->terminalCount; i++) {
+        capacity = 0;
+        for (k = graphPointer->firstMember[i]; k < graphPointer->firstMember[i + 1]; k++) {
+            memberPointer = graphPointer->memberList[k];
+            if (graphUsesEdge(graphPointer, memberPointer)) capacity += memberPointer->capacity;
+        }
 
-    newEdge->reverseEdge = (struct graphEdge *) reverseEdge;
-    reverseEdge->reverseEdge = (struct graphEdge *) newEdge;
+        /* undirected members of the reverse arc carry their capacity in this direction too */
+        arc = REVERSE(i);
+        for (k = graphPointer->firstMember[arc]; k < graphPointer->firstMember[arc + 1]; k++) {
+            memberPointer = graphPointer->memberList[k];
+            if (memberPointer->isUndirected && graphUsesEdge(graphPointer, memberPointer)) {
+                capacity += memberPointer->capacity;
+            }
+        }
+        graphSetCapacity(graphPointer, i, capacity);
+    }
 
-    hashTableAddUncheckedElement(newEdge, newEdge->source, graphPointer->edges);
-    hashTableAddUncheckedElement(reverseEdge, reverseEdge->source, graphPointer->edges);
+    /* residual capacities were changed from outside of the solve */
+    graphPointer->touchedCount = -1;
 }
 
 /* ____________________________________________________________________________
 
-    long graphMaxFlow(graph *graphPointer, int source, int target)
+    void graphSplitFlow(graph *graphPointer)
 
-    Finds maximal flow between source and target nodes.
+    Splits flow of every pair of arcs back to its member edges. Members of
+    the arc which carries the flow are filled up to their capacity in the
+    order in which they were added, then undirected members of the
+    reverse arc are filled, their flow is negative (it goes from target to
+    source of the edge).
    ____________________________________________________________________________
 */
-long graphMaxFlow(graph *graphPointer, int source, int target) {
-    if (!graphPointer) return -1;
+void graphSplitFlow(graph *graphPointer) {
+    int i;
+    int k;
+    int arc;
+    double flow;
+    graphEdge *memberPointer;
+    graphEdge *lastPointer;
+
+    if (!graphPointer) return;
+
+    for (i = 0; i < graphPointer->arcCount; i += 2) {
+        /* negative flow means that the flow goes through the reverse arc */
+        flow = graphArcFlow(graphPointer, i);
+        arc = flow < 0 ? REVERSE(i) : i;
+        if (flow < 0) flow = -flow;
+        lastPointer = NULL;
+
+        for (k = graphPointer->firstMember[arc]; k < graphPointer->firstMember[arc + 1]; k++) {
+            memberPointer = graphPointer->memberList[k];
+            memberPointer->flow = 0;
+            if (!graphUsesEdge(graphPointer, memberPointer)) continue;
+
+            memberPointer->flow = MIN(flow, memberPointer->capacity);
+            flow -= memberPointer->flow;
+            lastPointer = memberPointer;
+        }
+
+        arc = REVERSE(arc);
+        for (k = graphPointer->firstMember[arc]; k < graphPointer->firstMember[arc + 1]; k++) {
+            memberPointer = graphPointer->memberList[k];
+            memberPointer->flow = 0;
+            if (!memberPointer->isUndirected || !graphUsesEdge(graphPointer, memberPointer)) continue;
+
+            /* an idle edge keeps positive zero, negative zero would read as flow from target to source */
+            if (MIN(flow, memberPointer->capacity) > 0) memberPointer->flow = -MIN(flow, memberPointer->capacity);
+            flow += memberPointer->flow;
+            lastPointer = memberPointer;
+        }
+
+        /* the last member takes what rounding of floating capacities left */
+        if (flow > 0 && lastPointer) lastPointer->flow += lastPointer->flow < 0 ? -flow : flow;
+    }
+}
+
+/* ____________________________________________________________________________
 
-    if (source < 0 || target < 0) return -1;
+    int graphMaxFlowBetween(graph *graphPointer, int source, int target,
+                            int engine, double timeLimit,
+                            double gapLimit)
 
-    graphPointer->maxFlow = 0;
+    Finds maximal flow between source and target nodes (indices of the
+    nodes), see graphMaxFlow. Returns boolean value if it was successful.
+   ____________________________________________________________________________
+*/
+static int graphMaxFlowBetween(graph *graphPointer, int source, int target, int engine, double timeLimit,
+                               double gapLimit) {
+    memset(&graphPointer->maxFlow, 0, sizeof(flowValue));
     graphPointer->source = source;
     graphPointer->target = target;
+    graphPointer->timeLimit = timeLimit;
+    graphPointer->gapLimit = gapLimit;
+    graphPointer->engine = engine;
+    graphPointer->phaseCount = 0;
+    graphPointer->checkpointTime = (double) time(NULL);
+
+    free(graphPointer->bestCut);
+    graphPointer->bestCut = NULL;
+    if (timeLimit > 0 || gapLimit > 0) {
+        graphPointer->bestCut = malloc(graphPointer->nodeCount);
+        if (!graphPointer->bestCut) return FAILURE;
+    }
+
+    /* the solve continues from the flow of the checkpoint, only the first one is resumed */
+    if (graphPointer->resumeName) {
+        if (!graphReadCheckpoint(graphPointer, graphPointer->resumeName)) return FAILURE;
+        graphPointer->resumeName = NULL;
+    }
 
     graphSolve(graphPointer);
 
-    return graphPointer->maxFlow;
+    return SUCCESS;
 }
 
 /* ____________________________________________________________________________
 
-    void graphSolve(graph *graphPointer)
+    int graphMaxFlow(graph *graphPointer, int source, int target,
+                     int engine, double timeLimit, double gapLimit)
+
+    Finds maximal flow between source and target nodes (ids of the nodes),
+    the flow is stored in maxFlow of the graph. Engine decides how blocking
+    flow of every phase is found, ENGINE_DINIC uses depth first search,
+    ENGINE_DYNAMIC uses dynamic trees (see dynamicTree.c), ENGINE_PLANAR
+    finds the whole flow by shortest paths of the dual graph if the graph
+    is planar (see planar.c) and uses depth first search otherwise. If
+    timeLimit (in seconds of processor time) or gapLimit (relative gap
+    between lower and upper bound) is greater than zero, the algorithm can
+    stop before the maximal flow is found, then graph struct holds the flow
+    found so far, the upper bound and the best cut (see graphSolve). If
+    checkpointName of the graph is set, the flow is saved there between
+    phases (see graphCheckpoint), if resumeName is set, the solve starts
+    from the flow of that checkpoint. Returns FAILURE if some of the nodes
+    is not in the graph or if the checkpoint can't be resumed.
+   ____________________________________________________________________________
+*/
+int graphMaxFlow(graph *graphPointer, int source, int target, int engine, double timeLimit, double gapLimit) {
+    graphNode *sourceNode;
+    graphNode *targetNode;
+
+    if (!graphPointer) return FAILURE;
+
+    sourceNode = hashTableGetElement(source, graphPointer->nodes);
+    targetNode = hashTableGetElement(target, graphPointer->nodes);
+    if (!sourceNode || !targetNode) return FAILURE;
 
-    Runs the Dinics algorithm to find maximal flow from source to target
-    (both nodes defined in graph struct).
+    return graphMaxFlowBetween(graphPointer, sourceNode->index, targetNode->index, engine, timeLimit, gapLimit);
+}
+
+/* ____________________________________________________________________________
+
+    int graphTerminalMaxFlow(graph *graphPointer, int engine,
+                             double timeLimit, double gapLimit)
+
+    Finds maximal flow from all sources to all targets added by
+    graphAddTerminals, arguments are the same as in graphMaxFlow. Returns
+    FAILURE if the graph has no terminals.
    ____________________________________________________________________________
 */
-void graphSolve(graph *graphPointer) {
+int graphTerminalMaxFlow(graph *graphPointer, int engine, double timeLimit, double gapLimit) {
+    if (!graphPointer || !graphPointer->terminalCount) return FAILURE;
+
+    return graphMaxFlowBetween(graphPointer, graphPointer->nodeCount - 2, graphPointer->nodeCount - 1, engine,
+                               timeLimit, gapLimit);
+}
+
+/* ____________________________________________________________________________
+
+    graph *graphCreateView(graph *shared)
+
+    Creates graph which shares layout, capacities and members with the
+    shared graph, but has its own nodes array, residual capacities and
+    lists of visited and touched nodes, so several views can be solved by
+    several threads at once. The shared
+    graph must not be changed or freed while the view is used. Returns
+    pointer to the view or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+graph *graphCreateView(graph *shared) {
     int i;
-    int j;
-    long f;
-    graphNode *node;
-    intQueue *queue;
+    graph *view;
+
+    if (!shared) return NULL;
+
+    view = malloc(sizeof(graph));
+    if (!view) return NULL;
+
+    *view = *shared;
+    view->bestCut = NULL;
+    view->checkpointName = NULL;
+    view->resumeName = NULL;
+    view->source = -1;
+    view->target = -1;
+    view->nodeList = malloc(shared->nodeCount * sizeof(graphNode));
+    view->residual = malloc((shared->arcCount + 1) * graphFlowSize(shared->flowType));
+    view->visited = malloc((shared->nodeCount + 1) * sizeof(int));
+    view->touched = malloc(shared->nodeCount * sizeof(int));
+    view->isTouched = calloc(shared->nodeCount, sizeof(char));
+    if (!view->nodeList || !view->residual || !view->visited || !view->touched || !view->isTouched) {
+        freeGraphView(&view);
+        return NULL;
+    }
 
-    if (!graphPointer || graphPointer->source == -1 || graphPointer->target == -1) return;
-    queue = createIntQueue(INITIAL_SIZE);
+    memcpy(view->nodeList, shared->nodeList, shared->nodeCount * sizeof(graphNode));
+    for (i = 0; i < view->nodeCount; i++) view->nodeList[i].level = -1;
+    view->visitedCount = 0;
+    view->targetCount = 0;
+    view->touchedCount = -1;
+    graphResetResidual(view);
+    return view;
+}
+
+/* ____________________________________________________________________________
+
+    void graphTouchNode(graph *graphPointer, int node)
+
+    Adds the node to the list of touched nodes, arcs of touched nodes are
+    the only arcs whose residual capacities can be changed by the solve.
+   ____________________________________________________________________________
+*/
+static void graphTouchNode(graph *graphPointer, int node) {
+    if (graphPointer->touchedCount < 0 || graphPointer->isTouched[node]) return;
+
+    graphPointer->isTouched[node] = 1;
+    graphPointer->touched[graphPointer->touchedCount++] = node;
+}
 
-    if (!queue) return;
+/* ____________________________________________________________________________
 
-    /* graphBfs function creates level graph, and checks if sink is reachable */
-    while (graphBfs(graphPointer, queue)) {
+    void graphClearTargetSide(graph *graphPointer)
 
-        /* reset next variable of all nodes to initial state */
-        for (i = 0; i < graphPointer->nodes->size; i++) {
-            for (j = 0; j < graphPointer->nodes->array[i]->filledItems; j++) {
-                node = arrayListGetPointer(graphPointer->nodes->array[i], j);
-                if (node) node->next = 0;
+    Changes level of the nodes of the target side list (they have level -2)
+    back to -1 and empties the list. The list is kept at the end of the
+    visited array, its item k is visited[nodeCount - k].
+   ____________________________________________________________________________
+*/
+static void graphClearTargetSide(graph *graphPointer) {
+    int i;
+    int node;
+
+    for (i = 0; i < graphPointer->targetCount; i++) {
+        node = graphPointer->visited[graphPointer->nodeCount - i];
+        if (graphPointer->nodeList[node].level == -2) graphPointer->nodeList[node].level = -1;
+    }
+    graphPointer->targetCount = 0;
+}
+
+/* ____________________________________________________________________________
+
+    void graphCopyResidual(graph *graphPointer, char *values)
+
+    Sets residual capacities of the arcs to values (array of the flow type
+    of the graph). Only arcs of the touched nodes are set, so it costs
+    time proportional to the part of the graph which was explored by the
+    previous solve. If the residual capacities were set from outside
+    (touchedCount is -1), all arcs are set.
+   ____________________________________________________________________________
+*/
+static void graphCopyResidual(graph *graphPointer, char *values) {
+    int i;
+    int j;
+    int node;
+    size_t size = graphFlowSize(graphPointer->flowType);
+    char *residual = graphPointer->residual;
+
+    if (graphPointer->touchedCount < 0) {
+        memcpy(residual, values, (graphPointer->arcCount + 1) * size);
+        memset(graphPointer->isTouched, 0, graphPointer->nodeCount);
+    } else {
+        /* reverse arcs of the changed arcs belong to touched nodes too */
+        for (i = 0; i < graphPointer->touchedCount; i++) {
+            node = graphPointer->touched[i];
+            graphPointer->isTouched[node] = 0;
+            for (j = graphPointer->firstArc[node]; j < graphPointer->firstArc[node + 1]; j++) {
+                memcpy(residual + graphPointer->arcs[j] * size, values + graphPointer->arcs[j] * size, size);
             }
         }
+    }
 
-        /* graphDfs function finds augmenting paths, until blocking flow is reached,
-           it means that with current level graph configuration, we can't find another
-           augmenting paths, so the outer loop must run again, and create level graph
-           again */
+    graphPointer->touchedCount = 0;
+}
 
-        do {
-            f = graphDfs(graphPointer->source, graphPointer, INF);
-            graphPointer->maxFlow += f;
-        } while (f);
-    }
-    intQueueFreeQueue(&queue);
+/* ____________________________________________________________________________
+
+    void graphResetResidual(graph *graphPointer)
+
+    Sets residual capacities of all arcs back to their capacities, so the
+    graph can be solved again (see graphCopyResidual).
+   ____________________________________________________________________________
+*/
+void graphResetResidual(graph *graphPointer) {
+    graphCopyResidual(graphPointer, graphPointer->capacity);
+    memset(&graphPointer->maxFlow, 0, sizeof(flowValue));
+    memset(&graphPointer->upperBound, 0, sizeof(flowValue));
 }
 
 /* ____________________________________________________________________________
 
-    int graphBfs(graph *graphPointer, intQueue *queue)
+    int compareId(const void *a, const void *b)
+
+    Auxiliary function which compares two edge ids. Necessary for using
+    qsort.
+   ____________________________________________________________________________
+*/
+static int compareId(const void *a, const void *b) {
+    return *(const int *) a - *(const int *) b;
+}
+
+/* ____________________________________________________________________________
 
-    At first, changes level of all nodes to -1 (makes the nodes unvisited).
-    Then creates "levels" in the graph. Returns boolean value if there is some
-    path to augment which leads from source node to target node.
+    int graphCutEdges(graph *graphPointer, int *ids, int size)
 
+    Must be called after the graph was solved. Writes ids of the edges of
+    the minimal cut into ids array (the same edges as writeToOutputFile
+    writes for exact flow), at most size of them. Only the arcs of the
+    source side of the cut are scanned. Returns number of the
+    edges in the cut, ids are sorted if all of them fit into the array.
    ____________________________________________________________________________
 */
-int graphBfs(graph *graphPointer, intQueue *queue) {
+int graphCutEdges(graph *graphPointer, int *ids, int size) {
     int i;
     int j;
-    int index;
-    graphNode *targetNode;
-    long capacity;
-    int *nodeId = malloc(sizeof(int));
-    graphEdge *loadedEdgePointer;
+    int k;
+    int arc;
+    int count = 0;
+    graphEdge *edgePointer;
+    graphNode *nodeList = graphPointer->nodeList;
+
+    graphMarkSourceSide(graphPointer);
 
-    if (!graphPointer || !nodeId || !queue) return 0;
+    /* nodes with level != -1 (the source side) are all in visited list */
+    for (i = 0; i < graphPointer->visitedCount; i++) {
+        if (nodeList[graphPointer->visited[i]].level == -1) continue;
 
-    /* mark all nodes unvisited */
-    for (i = 0; i < graphPointer->nodes->size; i++) {
-        for (j = 0; j < graphPointer->nodes->array[i]->filledItems; j++) {
-            targetNode = arrayListGetPointer(graphPointer->nodes->array[i], j);
-            if (targetNode) targetNode->level = -1;
+        for (j = graphPointer->firstArc[graphPointer->visited[i]];
+             j < graphPointer->firstArc[graphPointer->visited[i] + 1]; j++) {
+            arc = graphPointer->arcs[j];
+            if (nodeList[graphPointer->head[arc]].level != -1) continue;
+
+            /* members of the reverse arc cross the cut only if they are undirected */
+            for (k = graphPointer->firstMember[arc]; k < graphPointer->firstMember[arc + 1]; k++) {
+                edgePointer = graphPointer->memberList[k];
+                if (edgePointer->capacity == 0) continue;
+
+                if (count < size) ids[count] = edgePointer->id;
+                count++;
+            }
+            for (k = graphPointer->firstMember[REVERSE(arc)]; k < graphPointer->firstMember[REVERSE(arc) + 1]; k++) {
+                edgePointer = graphPointer->memberList[k];
+                if (edgePointer->capacity == 0 || !edgePointer->isUndirected) continue;
+
+                if (count < size) ids[count] = edgePointer->id;
+                count++;
+            }
         }
     }
-    /* mark source nodeId visited */
-    targetNode = hashTableGetElement(graphPointer->source, graphPointer->nodes);
-    targetNode->level = 0;
 
-    intQueueEnque(queue, graphPointer->source);
+    if (count > 1 && count <= size) qsort(ids, count, sizeof(int), compareId);
+    return count;
+}
+
+/* ____________________________________________________________________________
 
-    while (!intQueueIsEmpty(queue)) {
-        /* this if statement should never be true, that will mean error in queue */
-        if (intQueueDeque(nodeId, queue) == -1) return 0;
+    int graphIsExact(graph *graphPointer)
 
-        /* make index fit to hashtable */
-        index = ABS(*nodeId % graphPointer->edges->size);
+    Returns boolean value if the flow of the graph reached its upper bound,
+    it means that the flow is maximal.
+   ____________________________________________________________________________
+*/
+int graphIsExact(graph *graphPointer) {
+    if (graphPointer->flowType == FLOW_REAL) return graphPointer->maxFlow.real == graphPointer->upperBound.real;
+    return graphPointer->maxFlow.integer == graphPointer->upperBound.integer;
+}
 
-        for (i = 0; i < graphPointer->edges->array[index]->filledItems; i++)    {
-            /*go through all the edges with source in nodeId (*nodeId)*/
-            loadedEdgePointer = (graphEdge *) arrayListGetPointer(graphPointer->edges->array[index], i);
+/* ____________________________________________________________________________
 
-            /* in the hashtable is possible to have more nodes in one place */
-            if (loadedEdgePointer->source < *nodeId) continue;
-            if (loadedEdgePointer->source > *nodeId) break;
+    int graphHasFlow(graph *graphPointer)
 
-            capacity = remainingCapacity(loadedEdgePointer);
+    Returns boolean value if the flow of the graph is greater than zero.
+   ____________________________________________________________________________
+*/
+int graphHasFlow(graph *graphPointer) {
+    if (graphPointer->flowType == FLOW_REAL) return graphPointer->maxFlow.real > 0;
+    return graphPointer->maxFlow.integer > 0;
+}
 
-            /* if the edge has some remaining capacity and if the target nodeId of the edge was not
-               visited yet */
-            targetNode = hashTableGetElement(loadedEdgePointer->target, graphPointer->nodes);
-            if (targetNode->level == -1 && capacity > 0) {
+/* ____________________________________________________________________________
 
-                /* mark as visited */
-                targetNode->level = ((graphNode *) hashTableGetElement(*nodeId, graphPointer->nodes))->level + 1;
+    char *graphFormatFlow(graph *graphPointer, flowValue value,
+                          char *buffer)
 
-                intQueueEnque(queue, loadedEdgePointer->target);
-            }
-        }
+    Writes the value (flow or upper bound of the graph) to the buffer, which
+    must have at least FLOW_BUFFER_SIZE chars. Returns the buffer.
+   ____________________________________________________________________________
+*/
+char *graphFormatFlow(graph *graphPointer, flowValue value, char *buffer) {
+    if (graphPointer->flowType == FLOW_REAL) {
+        sprintf(buffer, "%.15g", value.real);
+    } else {
+        sprintf(buffer, "%ld", value.integer);
     }
-    free(nodeId);
-    /* return boolean value whether sink nodeId was reached (visited) */
-    return ((graphNode *)hashTableGetElement(graphPointer->target, graphPointer->nodes))->level != -1;
+    return buffer;
 }
 
 /* ____________________________________________________________________________
 
-    long graphDfs(unsigned int node, graph *graphPointer, long flow)
+    int graphGetResidual(graph *graphPointer, long *residual)
 
-    RECURSIVE FUNCTION
-    Finds augmenting path from source to target. Augments all the edges in
-    the path. Removes dead ends by increasing next variable. Returns the
-    augmenting value.
+    Copies residual capacities of all arcs to the residual array. Returns
+    FAILURE if the graph has floating capacities, which can't be copied.
    ____________________________________________________________________________
 */
-long graphDfs(int node, graph *graphPointer, long flow) {
-    int index;
-    int sourceNodeNext;
-    uint edgesCount;
-    long capacity;
-    long bottleNeck;
+int graphGetResidual(graph *graphPointer, long *residual) {
+    int i;
 
-    graphEdge *loadedEdgePointer;
-    graphNode *sourceNode;
-    graphNode *targetNode;
+    switch (graphPointer->flowType) {
+        case FLOW_INT:
+            for (i = 0; i < graphPointer->arcCount; i++) residual[i] = ((int *) graphPointer->residual)[i];
+            return SUCCESS;
+
+        case FLOW_LONG:
+            memcpy(residual, graphPointer->residual, graphPointer->arcCount * sizeof(long));
+            return SUCCESS;
+
+        default:
+            return FAILURE;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void graphSetResidual(graph *graphPointer, long *residual)
+
+    Copies the residual array back to the residual capacities of the arcs,
+    it's the opposite of graphGetResidual.
+   ____________________________________________________________________________
+*/
+void graphSetResidual(graph *graphPointer, long *residual) {
+    int i;
 
-    if (!graphPointer) return 0;
-    /* sink node was reached */
-    if (node == graphPointer->target) return flow;
+    /* any arc can be changed, so graphResetResidual must reset all of them */
+    graphPointer->touchedCount = -1;
 
-    /* make node index fit the hashtable */
-    index = ABS(node % graphPointer->edges->size);
+    switch (graphPointer->flowType) {
+        case FLOW_INT:
+            for (i = 0; i < graphPointer->arcCount; i++) ((int *) graphPointer->residual)[i] = (int) residual[i];
+            break;
 
-    edgesCount = graphPointer->edges->array[index]->filledItems;
-    sourceNode = hashTableGetElement(node, graphPointer->nodes);
+        case FLOW_LONG:
+            memcpy(graphPointer->residual, residual, graphPointer->arcCount * sizeof(long));
+            break;
 
+        default:
+            break;
+    }
+}
 
-    if (!sourceNode) return 0;
+/* ____________________________________________________________________________
 
-    /* local copy of sourceNode->next, sourceNode->next can't be directly used because
-       hashtable can contain two nodes with different IDs in one place */
-    sourceNodeNext = sourceNode->next;
+    void graphCheckpoint(graph *graphPointer)
 
-    for (; sourceNodeNext < edgesCount; sourceNodeNext++) {
-        loadedEdgePointer = (graphEdge *) arrayListGetPointer(graphPointer->edges->array[index], sourceNodeNext);
+    Called between phases of the solve, writes checkpoint of the flow (see
+    checkpoint.c) if checkpointInterval seconds passed since the last one.
+    Failed checkpoint doesn't stop the solve, the next phase tries again.
+   ____________________________________________________________________________
+*/
+static void graphCheckpoint(graph *graphPointer) {
+    double now = (double) time(NULL);
 
-        if (!loadedEdgePointer) return 0;
+    if (now - graphPointer->checkpointTime < graphPointer->checkpointInterval) return;
+    if (graphWriteCheckpoint(graphPointer, graphPointer->checkpointName)) graphPointer->checkpointTime = now;
+}
 
-        /* in case that in hashtable edges there are more nodes on the same index */
-        if (loadedEdgePointer->source < sourceNode->id) continue;
-        if (loadedEdgePointer->source > sourceNode->id) break;
+#define FLOW_TYPE int
+#define FLOW_FIELD integer
+#define FLOW_INF FLOW_INT_LIMIT
+#define FLOW_SUFFIX Int
+#include "graphVariant.h"
 
-        capacity = remainingCapacity(loadedEdgePointer);
+#define FLOW_TYPE long
+#define FLOW_FIELD integer
+#define FLOW_INF FLOW_LONG_LIMIT
+#define FLOW_SUFFIX Long
+#include "graphVariant.h"
 
-        targetNode = hashTableGetElement(loadedEdgePointer->target, graphPointer->nodes);
+#define FLOW_TYPE double
+#define FLOW_FIELD real
+#define FLOW_INF DBL_MAX
+#define FLOW_SUFFIX Real
+#include "graphVariant.h"
 
-        if (!targetNode) return 0;
+/* ____________________________________________________________________________
 
-        /* capacity of the edge must be greater than zero and we want only to take edges,
-           which can bring us "deeper" in the graph, so their level must be greater than
-           current level */
-        if (capacity > 0 && sourceNode->level + 1 == targetNode->level) {
-            bottleNeck = graphDfs(loadedEdgePointer->target, graphPointer, MIN(flow, capacity));
+    void graphSolve(graph *graphPointer)
 
-            if (bottleNeck > 0) {
-                augment(loadedEdgePointer, bottleNeck);
-                return bottleNeck;
-            }
-        }
+    Runs the Dinics algorithm variant which matches the capacity type of
+    the graph (see graphVariant.h).
+   ____________________________________________________________________________
+*/
+void graphSolve(graph *graphPointer) {
+    if (!graphPointer || graphPointer->source == -1 || graphPointer->target == -1) return;
+
+    switch (graphPointer->flowType) {
+        case FLOW_INT:
+            graphSolveInt(graphPointer);
+            break;
+
+        case FLOW_LONG:
+            graphSolveLong(graphPointer);
+            break;
+
+        default:
+            graphSolveReal(graphPointer);
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void graphMarkSourceSide(graph *graphPointer)
+
+    Must be called after the graph was solved. If the solve ended by the
+    search from the target (see graphBfs), only the target side of the
+    cut is known, so the source side is searched now and its nodes get
+    their level and they are put into visited list, as after any other
+    solve. Queries which need only the flow don't pay for it.
+   ____________________________________________________________________________
+*/
+void graphMarkSourceSide(graph *graphPointer) {
+    if (graphPointer->targetCount == 0) return;
+
+    switch (graphPointer->flowType) {
+        case FLOW_INT:
+            graphBfsInt(graphPointer, 0);
+            break;
+
+        case FLOW_LONG:
+            graphBfsLong(graphPointer, 0);
+            break;
+
+        default:
+            graphBfsReal(graphPointer, 0);
+            break;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void graphRestoreResidual(graph *view, graph *base)
+
+    Sets residual capacities and the flow of the view back to those of the
+    solved graph which the view shares (see graphCopyResidual).
+   ____________________________________________________________________________
+*/
+void graphRestoreResidual(graph *view, graph *base) {
+    graphCopyResidual(view, base->residual);
+    view->maxFlow = base->maxFlow;
+}
 
-        /* sourceNode->next++ removes the dead end, for example, if value at
-       sourceNode->next was 0, and sink node was not reached, sourceNode->next
-       will be incremented to 1 and the edge on index 0 will not be used in
-       next iterations of dfs */
-        sourceNode->next++;
+/* ____________________________________________________________________________
+
+    void graphRemovalDrop(graph *view, int arc, graphEdge *edgePointer,
+                          flowValue *drop)
+
+    The view must hold maximal flow (see graphRestoreResidual). Finds how
+    much the maximal flow drops when the edge, which is member of the arc,
+    is removed (see graphRemovalFlow) and stores it into drop. Residual
+    capacities of the view are changed.
+   ____________________________________________________________________________
+*/
+void graphRemovalDrop(graph *view, int arc, graphEdge *edgePointer, flowValue *drop) {
+    flowValue before = view->maxFlow;
+
+    switch (view->flowType) {
+        case FLOW_INT:
+            drop->integer = before.integer - graphRemovalFlowInt(view, arc, (int) edgePointer->capacity,
+                                                                 edgePointer->isUndirected);
+            break;
+
+        case FLOW_LONG:
+            drop->integer = before.integer - graphRemovalFlowLong(view, arc, (long) edgePointer->capacity,
+                                                                  edgePointer->isUndirected);
+            break;
+
+        default:
+            drop->real = before.real - graphRemovalFlowReal(view, arc, edgePointer->capacity,
+                                                            edgePointer->isUndirected);
     }
+}
 
-    /* sink node was not reached */
-    return 0;
+/* ____________________________________________________________________________
+
+    void freeGraphView(graph **view)
+
+    Frees the view made by graphCreateView, arrays of the shared graph are
+    kept. Sets the pointer to NULL.
+   ____________________________________________________________________________
+*/
+void freeGraphView(graph **view) {
+    if (!view || !*view) return;
+
+    free((*view)->bestCut);
+    free((*view)->residual);
+    free((*view)->nodeList);
+    free((*view)->isTouched);
+    free((*view)->touched);
+    free((*view)->visited);
+    free(*view);
+    *view = NULL;
 }
 
 /* ____________________________________________________________________________
 
     void freeNewGraph(graph **graphPointer)
 
-    Deallocates memory used by graph.
+    Deallocates memory used by graph. Nodes table and members of the arcs
+    are not deallocated, they are owned by the caller.
    ____________________________________________________________________________
 */
 void freeNewGraph(graph **graphPointer) {
-
     if (!graphPointer || !*graphPointer) return;
 
-    freeHashTable(&(*graphPointer)->edges);
-
+    free((*graphPointer)->bestCut);
+    mappedStoreFree((*graphPointer)->store, (*graphPointer)->memberList);
+    mappedStoreFree((*graphPointer)->store, (*graphPointer)->firstMember);
+    mappedStoreFree((*graphPointer)->store, (*graphPointer)->capacity);
+    mappedStoreFree((*graphPointer)->store, (*graphPointer)->residual);
+    mappedStoreFree((*graphPointer)->store, (*graphPointer)->head);
+    mappedStoreFree((*graphPointer)->store, (*graphPointer)->arcs);
+    mappedStoreFree((*graphPointer)->store, (*graphPointer)->firstArc);
+    mappedStoreFree(graphNodeStore(*graphPointer), (*graphPointer)->isTouched);
+    mappedStoreFree(graphNodeStore(*graphPointer), (*graphPointer)->touched);
+    mappedStoreFree(graphNodeStore(*graphPointer), (*graphPointer)->visited);
+    mappedStoreFree(graphNodeStore(*graphPointer), (*graphPointer)->nodeList);
+    freeMappedStore(&(*graphPointer)->store);
     free(*graphPointer);
     *graphPointer = NULL;
 }
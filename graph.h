@@ -4,12 +4,28 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <time.h>
 #include "arrayList.h"
 #include "inputOutput.h"
 #include "intQueue.h"
+#include "order.h"
+#include "dynamicTree.h"
+#include "planar.h"
+#include "checkpoint.h"
 
-#define INF (LONG_MAX / 2)
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#define REVERSE(arc) ((arc) ^ 1)
+
+#define FLOW_INT 0
+#define FLOW_LONG 1
+#define FLOW_REAL 2
+#define FLOW_INT_LIMIT (INT_MAX / 2)
+#define FLOW_LONG_LIMIT (LONG_MAX / 2)
+#define FLOW_BUFFER_SIZE 32
+#define FLOW_EPSILON 1e-9
+#define ENGINE_DINIC 0
+#define ENGINE_DYNAMIC 1
+#define ENGINE_PLANAR 2
 
 /* ____________________________________________________________________________
 
@@ -17,15 +33,33 @@
    ____________________________________________________________________________
 */
 
-graphEdge *createReverseEdge(int from, int to);
-long remainingCapacity(graphEdge *edgePointer);
-void augment(graphEdge *edgePointer, long bottleNeck);
-graph *createNewGraph(hashTable *nodesTable, hashTable *edgesTable);
-void graphAddEdge(graphEdge *oldEdge, graph *graphPointer);
-long graphMaxFlow(graph *graphPointer, int source, int target);
+size_t graphFlowSize(int flowType);
+int graphEngineFromName(char *name);
+int graphFindArc(int from, int to, graph *graphPointer);
+graph *createNewGraph(hashTable *nodesTable, hashTable *edgesTable, int order);
+graph *createMappedGraph(hashTable *nodesTable, hashTable *edgesTable, int order, mappedStore *store);
+int graphAddTerminals(graph *graphPointer, graphTerminal *sources, int sourceCount, graphTerminal *targets,
+                      int targetCount);
+int graphAddEdge(graphEdge *oldEdge, graph *graphPointer);
+double graphArcFlow(graph *graphPointer, int arc);
+int graphUsesEdge(graph *graphPointer, graphEdge *edgePointer);
+void graphUseInvalid(graph *graphPointer, int use);
+void graphSplitFlow(graph *graphPointer);
+int graphMaxFlow(graph *graphPointer, int source, int target, int engine, double timeLimit, double gapLimit);
+int graphTerminalMaxFlow(graph *graphPointer, int engine, double timeLimit, double gapLimit);
 void graphSolve(graph *graphPointer);
-int graphBfs(graph *graphPointer, intQueue *queue);
-long graphDfs(int node, graph *graphPointer, long flow);
+graph *graphCreateView(graph *shared);
+void graphResetResidual(graph *graphPointer);
+void graphRestoreResidual(graph *view, graph *base);
+void graphRemovalDrop(graph *view, int arc, graphEdge *edgePointer, flowValue *drop);
+int graphCutEdges(graph *graphPointer, int *ids, int size);
+void graphMarkSourceSide(graph *graphPointer);
+int graphIsExact(graph *graphPointer);
+int graphHasFlow(graph *graphPointer);
+char *graphFormatFlow(graph *graphPointer, flowValue value, char *buffer);
+int graphGetResidual(graph *graphPointer, long *residual);
+void graphSetResidual(graph *graphPointer, long *residual);
+void freeGraphView(graph **view);
 void freeNewGraph(graph **graphPointer);
 
 #endif
\ No newline at end of file
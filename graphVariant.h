@@ -0,0 +1,514 @@
+/* ____________________________________________________________________________
+
+    Header graphVariant.h
+    Dinics algorithm written once for all capacity types. The header has
+    no include guard, graph.c includes it once for every variant, before
+    that it defines:
+        FLOW_TYPE   - type of residual capacities and flows (int, long,
+                      double),
+        FLOW_FIELD  - member of flowValue which keeps the flow,
+        FLOW_INF    - value which is bigger than any flow of the variant,
+        FLOW_SUFFIX - suffix of the names of the functions (Int, Long,
+                      Real).
+    The macros are undefined at the end of the header. Variant is chosen
+    in createNewGraph by the total capacity of the edges, so flows of the
+    variant can't overflow.
+   ____________________________________________________________________________
+*/
+
+#define FLOW_JOIN(name, suffix) name##suffix
+#define FLOW_EXPAND(name, suffix) FLOW_JOIN(name, suffix)
+#define FLOW_NAME(name) FLOW_EXPAND(name, FLOW_SUFFIX)
+
+/* ____________________________________________________________________________
+
+    void augment(graph *graphPointer, int arc, FLOW_TYPE bottleNeck)
+
+    Updates remaining capacity of the arc and of its reverse arc.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(augment)(graph *graphPointer, int arc, FLOW_TYPE bottleNeck) {
+    FLOW_TYPE *residual = graphPointer->residual;
+
+    residual[arc] -= bottleNeck;
+    residual[REVERSE(arc)] += bottleNeck;
+}
+
+/* ____________________________________________________________________________
+
+    void graphInitBounds(graph *graphPointer)
+
+    Sets upper bound of the flow to the smaller of the cuts around source
+    and around target node, the cut is remembered in bestCut array (1 for
+    nodes on the source side).
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(graphInitBounds)(graph *graphPointer) {
+    int i;
+    FLOW_TYPE sourceCut = 0;
+    FLOW_TYPE targetCut = 0;
+    FLOW_TYPE *residual = graphPointer->residual;
+    int *arcs = graphPointer->arcs;
+
+    for (i = graphPointer->firstArc[graphPointer->source]; i < graphPointer->firstArc[graphPointer->source + 1]; i++) {
+        sourceCut += residual[arcs[i]];
+    }
+    /* arcs into the target are reverse arcs of the target arcs */
+    for (i = graphPointer->firstArc[graphPointer->target]; i < graphPointer->firstArc[graphPointer->target + 1]; i++) {
+        targetCut += residual[REVERSE(arcs[i])];
+    }
+
+    graphPointer->upperBound.FLOW_FIELD = graphPointer->maxFlow.FLOW_FIELD + MIN(sourceCut, targetCut);
+    for (i = 0; i < graphPointer->nodeCount; i++) {
+        graphPointer->bestCut[i] = (char) (sourceCut <= targetCut ? i == graphPointer->source
+                                                                  : i != graphPointer->target);
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void graphUpdateBounds(graph *graphPointer, FLOW_TYPE *levelCut)
+
+    Must be called right after graphBfs found the target. Every set of nodes
+    with level lower or equal to k (k smaller than level of the target) is a
+    cut, its capacity is the current flow plus remaining capacity of arcs
+    from level k to level k + 1. If some of these cuts is smaller than the
+    upper bound, it becomes the new upper bound and the best cut. LevelCut
+    must have place for level of the target items.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(graphUpdateBounds)(graph *graphPointer, FLOW_TYPE *levelCut) {
+    int i;
+    int j;
+    int k;
+    int best = 0;
+    int level;
+    int targetLevel;
+    int arc;
+    FLOW_TYPE capacity;
+    FLOW_TYPE *residual = graphPointer->residual;
+    graphNode *nodeList = graphPointer->nodeList;
+
+    targetLevel = nodeList[graphPointer->target].level;
+    for (i = 0; i < targetLevel; i++) levelCut[i] = 0;
+
+    for (k = 0; k < graphPointer->visitedCount; k++) {
+        i = graphPointer->visited[k];
+        level = nodeList[i].level;
+        if (level == -1 || level >= targetLevel) continue;
+
+        for (j = graphPointer->firstArc[i]; j < graphPointer->firstArc[i + 1]; j++) {
+            arc = graphPointer->arcs[j];
+            capacity = residual[arc];
+            if (capacity > 0 && nodeList[graphPointer->head[arc]].level == level + 1) levelCut[level] += capacity;
+        }
+    }
+
+    for (i = 1; i < targetLevel; i++) {
+        if (levelCut[i] < levelCut[best]) best = i;
+    }
+
+    if (graphPointer->maxFlow.FLOW_FIELD + levelCut[best] < graphPointer->upperBound.FLOW_FIELD) {
+        graphPointer->upperBound.FLOW_FIELD = graphPointer->maxFlow.FLOW_FIELD + levelCut[best];
+        for (i = 0; i < graphPointer->nodeCount; i++) {
+            graphPointer->bestCut[i] = (char) (nodeList[i].level != -1 && nodeList[i].level <= best);
+        }
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int graphBfs(graph *graphPointer, int fromTarget)
+
+    At first, changes level of the nodes of the previous level graph to -1
+    (only the nodes in visited list and in target side list can have other
+    level). Then creates "levels" in the graph, visited list is used as the
+    queue and it keeps all nodes which got some level. Nodes behind the
+    level of the target are not expanded, because no augmenting path of
+    the phase goes through them. If fromTarget is set, the nodes which can
+    reach the target are searched from the target at the same time until
+    the searches meet (they get level -2 and they are kept in target side
+    list), the search which visited less nodes makes the next step. If
+    the search from the target finishes first, there is no path and the
+    rest of the source side doesn't have to be explored, the target side
+    list is kept until the next search. Returns boolean value if there is
+    some path to augment
+    which leads from source node to target node.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(graphBfs)(graph *graphPointer, int fromTarget) {
+    int i;
+    int node;
+    int arc;
+    int target;
+    int head = 0;
+    int targetHead = 0;
+    int levelEnd = 1;
+    int targetLevelEnd = 1;
+    int *visited = graphPointer->visited;
+    int *targetSide = graphPointer->visited + graphPointer->nodeCount;
+    FLOW_TYPE *residual = graphPointer->residual;
+    graphNode *nodeList = graphPointer->nodeList;
+
+    /* mark the nodes of the previous level graph unvisited */
+    for (i = 0; i < graphPointer->visitedCount; i++) {
+        nodeList[visited[i]].level = -1;
+    }
+    graphPointer->visitedCount = 0;
+    graphClearTargetSide(graphPointer);
+
+    /* mark source node visited, target node is the start of the other search */
+    nodeList[graphPointer->source].level = 0;
+    visited[graphPointer->visitedCount++] = graphPointer->source;
+    graphTouchNode(graphPointer, graphPointer->source);
+    if (fromTarget) {
+        nodeList[graphPointer->target].level = -2;
+        targetSide[-graphPointer->targetCount++] = graphPointer->target;
+    }
+
+    while (head < graphPointer->visitedCount) {
+        if (graphPointer->targetCount > 0 && graphPointer->targetCount <= graphPointer->visitedCount) {
+            /* the target side is complete, the source can't reach it */
+            if (targetHead == graphPointer->targetCount) return 0;
+
+            if (targetHead == targetLevelEnd) {
+                if (MAPPED_FROM_FILES(graphPointer->store)) {
+                    qsort(targetSide - graphPointer->targetCount + 1, graphPointer->targetCount - targetHead,
+                          sizeof(int), compareId);
+                }
+                targetLevelEnd = graphPointer->targetCount;
+            }
+
+            /* go through all the arcs with target in node */
+            node = targetSide[-targetHead++];
+            for (i = graphPointer->firstArc[node]; i < graphPointer->firstArc[node + 1]; i++) {
+                arc = graphPointer->arcs[i];
+                target = graphPointer->head[arc];
+                if (residual[REVERSE(arc)] <= 0 || nodeList[target].level == -2) continue;
+
+                /* the searches met, so the level graph is finished by the search from source */
+                if (nodeList[target].level != -1) {
+                    graphClearTargetSide(graphPointer);
+                    break;
+                }
+
+                nodeList[target].level = -2;
+                targetSide[-graphPointer->targetCount++] = target;
+            }
+            continue;
+        }
+
+        /* with mapped arrays every level is sorted, so its arcs are read in the order of
+           the layout and pages are faulted in one sweep (backwards for the target side) */
+        if (head == levelEnd) {
+            if (MAPPED_FROM_FILES(graphPointer->store)) {
+                qsort(visited + head, graphPointer->visitedCount - head, sizeof(int), compareId);
+            }
+            levelEnd = graphPointer->visitedCount;
+        }
+
+        node = visited[head++];
+
+        /* all nodes of the level of the target have their level already */
+        if (nodeList[graphPointer->target].level >= 0
+            && nodeList[node].level >= nodeList[graphPointer->target].level) break;
+
+        /* go through all the arcs with source in node */
+        for (i = graphPointer->firstArc[node]; i < graphPointer->firstArc[node + 1]; i++) {
+            arc = graphPointer->arcs[i];
+            target = graphPointer->head[arc];
+
+            /* if the arc has some remaining capacity and if the target node of the arc was not
+               visited yet */
+            if (nodeList[target].level < 0 && residual[arc] > 0) {
+
+                /* the searches met, so there is a path */
+                if (nodeList[target].level == -2) graphClearTargetSide(graphPointer);
+
+                /* mark as visited */
+                nodeList[target].level = nodeList[node].level + 1;
+                visited[graphPointer->visitedCount++] = target;
+                graphTouchNode(graphPointer, target);
+            }
+        }
+    }
+
+    /* the source side is complete, the nodes of the other search aren't needed */
+    graphClearTargetSide(graphPointer);
+
+    /* return boolean value whether sink node was reached (visited) */
+    return nodeList[graphPointer->target].level >= 0;
+}
+
+/* ____________________________________________________________________________
+
+    FLOW_TYPE graphDfs(int node, graph *graphPointer, FLOW_TYPE flow)
+
+    RECURSIVE FUNCTION
+    Finds augmenting path from source to target. Augments all the arcs in
+    the path. Removes dead ends by increasing next variable. Returns the
+    augmenting value.
+   ____________________________________________________________________________
+*/
+static FLOW_TYPE FLOW_NAME(graphDfs)(int node, graph *graphPointer, FLOW_TYPE flow) {
+    int arcsEnd;
+    int arc;
+    FLOW_TYPE capacity;
+    FLOW_TYPE bottleNeck;
+    FLOW_TYPE *residual = graphPointer->residual;
+
+    graphNode *sourceNode;
+    graphNode *targetNode;
+
+    /* sink node was reached */
+    if (node == graphPointer->target) return flow;
+
+    sourceNode = &graphPointer->nodeList[node];
+    arcsEnd = graphPointer->firstArc[node + 1];
+
+    for (; sourceNode->next < arcsEnd; sourceNode->next++) {
+        arc = graphPointer->arcs[sourceNode->next];
+        capacity = residual[arc];
+        targetNode = &graphPointer->nodeList[graphPointer->head[arc]];
+
+        /* capacity of the arc must be greater than zero and we want only to take arcs,
+           which can bring us "deeper" in the graph, so their level must be greater than
+           current level */
+        if (capacity > 0 && sourceNode->level + 1 == targetNode->level) {
+            bottleNeck = FLOW_NAME(graphDfs)(graphPointer->head[arc], graphPointer, MIN(flow, capacity));
+
+            if (bottleNeck > 0) {
+                FLOW_NAME(augment)(graphPointer, arc, bottleNeck);
+                return bottleNeck;
+            }
+        }
+
+        /* sourceNode->next++ removes the dead end, for example, if value at
+       sourceNode->next was 0, and sink node was not reached, sourceNode->next
+       will be incremented to 1 and the arc on index 0 will not be used in
+       next iterations of dfs */
+    }
+
+    /* sink node was not reached */
+    return 0;
+}
+
+/* ____________________________________________________________________________
+
+    void graphSolve(graph *graphPointer)
+
+    Runs the Dinics algorithm to find maximal flow from source to target
+    (indices of both nodes defined in graph struct). If the graph has
+    bestCut array, upper bound of the flow is kept and the algorithm stops
+    when the gap between maxFlow and upperBound is closed to gapLimit or
+    when timeLimit runs out (checked after every augmenting path, or after
+    every phase with ENGINE_DYNAMIC engine). With ENGINE_PLANAR engine the
+    flow of planar graphs is found by planarFlow first, if the solve
+    starts from zero flow. Checkpoints of the flow are written between
+    phases if the graph has checkpointName. If the solve stops, levels of
+    the nodes are set to 0 on the source side of the best cut and to -1
+    on the other side.
+   ____________________________________________________________________________
+*/
+static void FLOW_NAME(graphSolve)(graph *graphPointer) {
+    int i;
+    int node;
+    int stopped = 0;
+    FLOW_TYPE f;
+    FLOW_TYPE *levelCut = NULL;
+    clock_t start = clock();
+
+    if (graphPointer->bestCut) {
+        levelCut = malloc(graphPointer->nodeCount * sizeof(FLOW_TYPE));
+        if (!levelCut) return;
+        FLOW_NAME(graphInitBounds)(graphPointer);
+    }
+
+    /* planar engine finds the whole flow at once, then the first level graph only
+       proves that it's maximal, otherwise Dinics algorithm finds the flow */
+    if (graphPointer->engine == ENGINE_PLANAR && graphPointer->maxFlow.FLOW_FIELD == 0) {
+        f = FLOW_NAME(planarFlow)(graphPointer);
+        if (f > 0) graphPointer->maxFlow.FLOW_FIELD = f;
+    }
+
+    /* graphBfs function creates level graph, and checks if sink is reachable,
+       state between two phases is the one which is saved in checkpoints */
+    while (!stopped) {
+        if (graphPointer->checkpointName) graphCheckpoint(graphPointer);
+        if (!FLOW_NAME(graphBfs)(graphPointer, 1)) {
+            /* there is no augmenting path, so the flow is maximal */
+            graphPointer->upperBound.FLOW_FIELD = graphPointer->maxFlow.FLOW_FIELD;
+            break;
+        }
+
+        if (levelCut) {
+            FLOW_NAME(graphUpdateBounds)(graphPointer, levelCut);
+            if (graphPointer->upperBound.FLOW_FIELD - graphPointer->maxFlow.FLOW_FIELD
+                <= graphPointer->gapLimit * graphPointer->upperBound.FLOW_FIELD) {
+                stopped = 1;
+                break;
+            }
+        }
+
+        graphPointer->phaseCount++;
+
+        /* reset next variable of the nodes of the level graph to initial state */
+        for (i = 0; i < graphPointer->visitedCount; i++) {
+            node = graphPointer->visited[i];
+            graphPointer->nodeList[node].next = graphPointer->firstArc[node];
+        }
+
+        /* blocking flow is found by dynamic trees if the engine asks for it, if they
+           can't be allocated, the phase is done by graphDfs below */
+        f = -1;
+        if (graphPointer->engine == ENGINE_DYNAMIC) f = FLOW_NAME(dynamicTreeBlockingFlow)(graphPointer);
+        if (f >= 0) {
+            graphPointer->maxFlow.FLOW_FIELD += f;
+            if (levelCut && graphPointer->timeLimit > 0
+                && (double) (clock() - start) / CLOCKS_PER_SEC >= graphPointer->timeLimit) {
+                stopped = 1;
+            }
+            continue;
+        }
+
+        /* graphDfs function finds augmenting paths, until blocking flow is reached,
+           it means that with current level graph configuration, we can't find another
+           augmenting paths, so the outer loop must run again, and create level graph
+           again */
+
+        do {
+            f = FLOW_NAME(graphDfs)(graphPointer->source, graphPointer, FLOW_INF);
+            graphPointer->maxFlow.FLOW_FIELD += f;
+
+            if (levelCut && graphPointer->timeLimit > 0
+                && (double) (clock() - start) / CLOCKS_PER_SEC >= graphPointer->timeLimit) {
+                stopped = 1;
+                break;
+            }
+        } while (f > 0);
+    }
+
+    /* the solve was stopped, so the levels describe the best cut found */
+    if (stopped) {
+        graphPointer->visitedCount = 0;
+        for (i = 0; i < graphPointer->nodeCount; i++) {
+            graphPointer->nodeList[i].level = graphPointer->bestCut[i] ? 0 : -1;
+            if (graphPointer->bestCut[i]) graphPointer->visited[graphPointer->visitedCount++] = i;
+        }
+    }
+
+    free(levelCut);
+}
+
+/* ____________________________________________________________________________
+
+    FLOW_TYPE graphPushFlow(graph *graphPointer, int from, int to,
+                            FLOW_TYPE limit)
+
+    Sends at most limit units of flow from node from to node to (indices
+    of the nodes) by phases of Dinics algorithm, source and target of the
+    graph stay the same. Returns the amount which was sent.
+   ____________________________________________________________________________
+*/
+static FLOW_TYPE FLOW_NAME(graphPushFlow)(graph *graphPointer, int from, int to, FLOW_TYPE limit) {
+    int i;
+    int node;
+    int source = graphPointer->source;
+    int target = graphPointer->target;
+    FLOW_TYPE f;
+    FLOW_TYPE sent = 0;
+
+    graphPointer->source = from;
+    graphPointer->target = to;
+    while (sent < limit && FLOW_NAME(graphBfs)(graphPointer, 1)) {
+        for (i = 0; i < graphPointer->visitedCount; i++) {
+            node = graphPointer->visited[i];
+            graphPointer->nodeList[node].next = graphPointer->firstArc[node];
+        }
+        do {
+            f = FLOW_NAME(graphDfs)(from, graphPointer, limit - sent);
+            sent += f;
+        } while (f > 0 && sent < limit);
+    }
+    graphPointer->source = source;
+    graphPointer->target = target;
+
+    return sent;
+}
+
+/* ____________________________________________________________________________
+
+    FLOW_TYPE graphRemovalFlow(graph *graphPointer, int arc,
+                               FLOW_TYPE capacity, int undirected)
+
+    The graph must hold maximal flow from its source to its target.
+    Lowers capacity of the arc (and of the reverse arc if undirected is
+    set) by capacity and finds the maximal flow again. If the flow still
+    fits, it stays maximal. Flow which doesn't fit into the arc any more
+    is sent around it first, the rest is returned to the source and from
+    the target, then Dinics algorithm continues from that flow. If the
+    flow can't be reused (it goes out of the target or into the source),
+    the graph is solved from zero. Returns the new maximal flow, residual
+    capacities of the graph are changed.
+   ____________________________________________________________________________
+*/
+static FLOW_TYPE FLOW_NAME(graphRemovalFlow)(graph *graphPointer, int arc, FLOW_TYPE capacity, int undirected) {
+    int i;
+    int from;
+    int to;
+    int flowArc;
+    FLOW_TYPE excess;
+    FLOW_TYPE *residual = graphPointer->residual;
+
+    /* arcs of both ends of the arc are changed here, the rest by the searches */
+    graphTouchNode(graphPointer, graphPointer->head[arc]);
+    graphTouchNode(graphPointer, graphPointer->head[REVERSE(arc)]);
+    residual[arc] -= capacity;
+    if (undirected) residual[REVERSE(arc)] -= capacity;
+
+    /* at most one direction carries flow, its residual capacity is negative if the flow
+       doesn't fit */
+    for (i = 0; i < 2; i++) {
+        flowArc = i ? REVERSE(arc) : arc;
+        if (residual[flowArc] >= 0) continue;
+
+        excess = -residual[flowArc];
+        residual[flowArc] = 0;
+        residual[REVERSE(flowArc)] -= excess;
+
+        from = graphPointer->head[REVERSE(flowArc)];
+        to = graphPointer->head[flowArc];
+        excess -= FLOW_NAME(graphPushFlow)(graphPointer, from, to, excess);
+        if (excess <= 0) return graphPointer->maxFlow.FLOW_FIELD;
+
+        if (from == graphPointer->target || to == graphPointer->source
+            || (from != graphPointer->source
+                && FLOW_NAME(graphPushFlow)(graphPointer, from, graphPointer->source, excess) < excess)
+            || (to != graphPointer->target
+                && FLOW_NAME(graphPushFlow)(graphPointer, graphPointer->target, to, excess) < excess)) {
+            /* zero flow with the lowered capacities */
+            memcpy(residual, graphPointer->capacity, (graphPointer->arcCount + 1) * sizeof(FLOW_TYPE));
+            graphPointer->touchedCount = -1;
+            residual[arc] -= capacity;
+            if (undirected) residual[REVERSE(arc)] -= capacity;
+            graphPointer->maxFlow.FLOW_FIELD = 0;
+            break;
+        }
+        graphPointer->maxFlow.FLOW_FIELD -= excess;
+        break;
+    }
+
+    /* the flow still fits, so it's still maximal */
+    if (i == 2) return graphPointer->maxFlow.FLOW_FIELD;
+
+    FLOW_NAME(graphSolve)(graphPointer);
+    return graphPointer->maxFlow.FLOW_FIELD;
+}
+
+#undef FLOW_NAME
+#undef FLOW_EXPAND
+#undef FLOW_JOIN
+#undef FLOW_TYPE
+#undef FLOW_FIELD
+#undef FLOW_INF
+#undef FLOW_SUFFIX
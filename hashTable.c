@@ -49,7 +49,7 @@ int hashTableAddElement(void *element, int id, hashTable *table) {
     index = ABS(id % table->size);
 
     for (i = 0; i < table->array[index]->filledItems; i++) {
-        hashElement = arrayListGetPointer(table->array[index],0);
+        hashElement = arrayListGetPointer(table->array[index], i);
         if (((graphNode *)hashElement)->id == id) return 0;
     }
 
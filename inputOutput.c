@@ -13,6 +13,39 @@
 #include "arrayList.h"
 #include "structs.h"
 #include "inputOutput.h"
+#include "graph.h"
+
+/* ____________________________________________________________________________
+
+    char *nextToken(char *input, const char *delimiters, char **rest)
+
+    Works like strtok, but the position is kept in rest instead of static
+    variable, so nodes and edges can be parsed by several threads at once.
+    Input is the string for the first call, NULL for next calls.
+   ____________________________________________________________________________
+ */
+static char *nextToken(char *input, const char *delimiters, char **rest) {
+    char *start = input ? input : *rest;
+    char *end;
+
+    if (!start) return NULL;
+
+    start += strspn(start, delimiters);
+    if (!*start) {
+        *rest = start;
+        return NULL;
+    }
+
+    end = start + strcspn(start, delimiters);
+    if (*end) {
+        *end = '\0';
+        *rest = end + 1;
+    } else {
+        *rest = end;
+    }
+
+    return start;
+}
 
 /* ____________________________________________________________________________
 
@@ -26,35 +59,37 @@ graphNode *createNode(char *input) {
     graphNode *newNode;
     char *inputPart;
     char *invalidPart;
+    char *rest;
 
     if (!input || strlen(input) < 5) return NULL;
 
     newNode = malloc(sizeof(graphNode));
     if (!newNode) return NULL;
 
-    inputPart = strtok(input, ",");
+    inputPart = nextToken(input, ",", &rest);
     newNode->id = strtol(inputPart, &invalidPart, 10);
 
-    inputPart = strtok(NULL, ",");
-    newNode->wkt = malloc(strlen(inputPart));
+    inputPart = nextToken(NULL, ",", &rest);
+    newNode->wkt = inputPart ? malloc(strlen(inputPart) + 1) : NULL;
 
     if (!newNode->wkt) {
         free(newNode);
         return NULL;
     }
-    strncpy(newNode->wkt, inputPart, strlen(inputPart));
+    strcpy(newNode->wkt, inputPart);
     return newNode;
 }
 
 /* ____________________________________________________________________________
 
-    graphEdge *createEdge(char *input, int workWithInvalid)
+    graphEdge *createEdge(char *input, int workWithInvalid, int undirected)
 
     Tries to create edge from input string. Checks if edge is valid, if it is
-    returns pointer to new edge, else return NULL.
+    returns pointer to new edge, else return NULL. Undirected says if the
+    edge can carry flow in both directions.
    ____________________________________________________________________________
  */
-graphEdge *createEdge(char *input, int workWithInvalid) {
+graphEdge *createEdge(char *input, int workWithInvalid, int undirected) {
     graphEdge *newEdge;
     int i;
     uint wktLength;
@@ -62,6 +97,7 @@ graphEdge *createEdge(char *input, int workWithInvalid) {
     uint parsedLength;
     char *partString;
     char *part2;
+    char *rest;
 
     if (!input || strlen(input) < 14) return NULL;
     inputLength = strlen(input);
@@ -70,7 +106,7 @@ graphEdge *createEdge(char *input, int workWithInvalid) {
     newEdge = calloc(1, sizeof(graphEdge));
     if (!newEdge) return NULL;
 
-    partString = strtok(input, ",");
+    partString = nextToken(input, ",", &rest);
     for (i = 0; i < 4; i++) {
         switch (i) {
             case 0:
@@ -87,9 +123,9 @@ graphEdge *createEdge(char *input, int workWithInvalid) {
 
             case 3:
                 if (strchr(partString, '"')) {
-                    newEdge->capacity = strtol(&partString[1], &part2, 10);
+                    newEdge->capacity = strtod(&partString[1], &part2);
                 } else {
-                    newEdge->capacity = strtol(partString, &part2, 10);
+                    newEdge->capacity = strtod(partString, &part2);
                 }
                 break;
 
@@ -98,7 +134,7 @@ graphEdge *createEdge(char *input, int workWithInvalid) {
         }
 
         parsedLength += strlen(partString);
-        partString = strtok(NULL, ",");
+        partString = nextToken(NULL, ",", &rest);
     }
 
     if (!strncmp(partString, "True", 4)) {
@@ -113,12 +149,13 @@ graphEdge *createEdge(char *input, int workWithInvalid) {
     }
 
     parsedLength += strlen(partString);
-    partString = strtok(NULL, "&");
+    partString = nextToken(NULL, "&", &rest);
     wktLength = inputLength - parsedLength + 1;
     newEdge->wkt = malloc(wktLength);
 
     strncpy(newEdge->wkt, partString, wktLength);
     newEdge->flow = 0;
+    newEdge->isUndirected = (char) undirected;
 
     return newEdge;
 }
@@ -173,8 +210,8 @@ hashTable *loadNodes(char *inputName) {
         return NULL;
     }
 
-    do {
-        fgets(string, MAXLENGTH, inputFile);
+    /* the loop stops when fgets fails, so the last line isn't parsed twice */
+    while (fgets(string, MAXLENGTH, inputFile)) {
         newNode = createNode(string);
         if (newNode) {
             /* check if node with this id was already loaded */
@@ -184,7 +221,7 @@ hashTable *loadNodes(char *inputName) {
                 hashTableAddElement(newNode, newNode->id, table);
             }
         }
-    } while (!feof(inputFile));
+    }
 
     fclose(inputFile);
     free(string);
@@ -193,17 +230,19 @@ hashTable *loadNodes(char *inputName) {
 
 /* ____________________________________________________________________________
 
-    hashTable *loadEdges(char *inputName, int workWithInvalid, int tableSize)
+    hashTable *loadEdges(char *inputName, int workWithInvalid, int undirected,
+                         int tableSize)
 
     Tries to load data from file described by inputName parameter and create
     hashTable containing newly created edges, it filters duplicates.
-    WorkWithInvalid says if invalid edges should be used, tableSize determines
+    WorkWithInvalid says if invalid edges should be used, undirected says if
+    the edges can carry flow in both directions, tableSize determines
     size of the hashTable. Returns pointer to hashTable or NULL if some problem
     occurred.
    ____________________________________________________________________________
  */
 
-hashTable *loadEdges(char *inputName, int workWithInvalid, int tableSize) {
+hashTable *loadEdges(char *inputName, int workWithInvalid, int undirected, int tableSize) {
     hashTable *table;
     char *string;
     graphEdge *edgePointer;
@@ -235,14 +274,11 @@ hashTable *loadEdges(char *inputName, int workWithInvalid, int tableSize) {
 
     do {
         fgets(string, MAXLENGTH, inputFile);
-        edgePointer = createEdge(string, workWithInvalid);
-        if (edgePointer) {
-            /* check if edge with this id was already loaded */
-            if (hashTableContains(edgePointer->id, table)) {
-                freeGraphEdge(&edgePointer);
-            } else {
-                hashTableAddElement(edgePointer, edgePointer->id, table);
-            }
+        edgePointer = createEdge(string, workWithInvalid, undirected);
+        /* edge with id which was already loaded is not added, so duplicates
+           are dropped right away */
+        if (edgePointer && !hashTableAddElement(edgePointer, edgePointer->id, table)) {
+            freeGraphEdge(&edgePointer);
         }
     } while (!feof(inputFile));
 
@@ -252,6 +288,98 @@ hashTable *loadEdges(char *inputName, int workWithInvalid, int tableSize) {
     return table;
 }
 
+/* ____________________________________________________________________________
+
+    long copyLine(const char *data, long length, long position, char *line)
+
+    Copies line of data which starts at position into line (MAXLENGTH
+    characters at most, the new line character is kept, like with fgets).
+    Returns position where the next line starts.
+   ____________________________________________________________________________
+*/
+long copyLine(const char *data, long length, long position, char *line) {
+    int lineLength = 0;
+
+    while (position < length && lineLength < MAXLENGTH - 1) {
+        line[lineLength++] = data[position++];
+        if (line[lineLength - 1] == '\n') break;
+    }
+    line[lineLength] = '\0';
+
+    return position;
+}
+
+/* ____________________________________________________________________________
+
+    hashTable *parseNodes(const char *data, long length)
+
+    Works like loadNodes, but the nodes are read from data of given length
+    instead of file. Returns pointer to hashTable or NULL if the data are
+    invalid or if error occurred.
+   ____________________________________________________________________________
+*/
+hashTable *parseNodes(const char *data, long length) {
+    long i;
+    long position;
+    int counter = 0;
+    char line[MAXLENGTH];
+    hashTable *table;
+    graphNode *newNode;
+
+    if (!data) return NULL;
+
+    position = copyLine(data, length, 0, line);
+    if (strncmp(NODES_ID, line, strlen(NODES_ID)) != 0) return NULL;
+
+    for (i = position; i < length; i++) {
+        if (data[i] == '\n') counter++;
+    }
+
+    table = createHashTable(counter + 2, sizeof(graphNode));
+    if (!table) return NULL;
+
+    while (position < length) {
+        position = copyLine(data, length, position, line);
+        newNode = createNode(line);
+        if (newNode && !hashTableAddElement(newNode, newNode->id, table)) freeGraphNode(&newNode);
+    }
+
+    return table;
+}
+
+/* ____________________________________________________________________________
+
+    hashTable *parseEdges(const char *data, long length, int workWithInvalid,
+                          int undirected)
+
+    Works like loadEdges, but the edges are read from data of given length
+    instead of file. Returns pointer to hashTable or NULL if the data are
+    invalid or if error occurred.
+   ____________________________________________________________________________
+*/
+hashTable *parseEdges(const char *data, long length, int workWithInvalid, int undirected) {
+    long position;
+    char line[MAXLENGTH];
+    hashTable *table;
+    graphEdge *edgePointer;
+
+    if (!data) return NULL;
+
+    position = copyLine(data, length, 0, line);
+    if (strncmp(EDGES_ID, line, strlen(EDGES_ID)) != 0) return NULL;
+
+    table = createHashTable((int) (length / EDGE_ROW_ESTIMATE) + INITIAL_SIZE, sizeof(graphEdge));
+    if (!table) return NULL;
+
+    while (position < length) {
+        position = copyLine(data, length, position, line);
+        edgePointer = createEdge(line, workWithInvalid, undirected);
+        if (edgePointer && !hashTableAddElement(edgePointer, edgePointer->id, table)) freeGraphEdge(&edgePointer);
+    }
+
+    return table;
+}
+
 /* ____________________________________________________________________________
 
     void freeGraphNode(graphNode **nodePointer)
@@ -281,17 +409,38 @@ void freeGraphEdge(graphEdge **edgePointer) {
     *edgePointer = NULL;
 }
 
+/* ____________________________________________________________________________
+
+    int isSaturated(graphEdge *edgePointer)
+
+    Returns boolean value if flow of the edge fills its capacity, flow of
+    undirected edge can go in any direction. Floating capacities are
+    compared with relative tolerance FLOW_EPSILON.
+   ____________________________________________________________________________
+*/
+static int isSaturated(graphEdge *edgePointer) {
+    double capacity = edgePointer->capacity < 0 ? -edgePointer->capacity : edgePointer->capacity;
+    double flow = edgePointer->isUndirected && edgePointer->flow < 0 ? -edgePointer->flow : edgePointer->flow;
+
+    return edgePointer->capacity - flow <= FLOW_EPSILON * capacity;
+}
+
 /* ____________________________________________________________________________
 
     int writeToOutputFile(char *fileName, graph *graphPointer)
 
     Tries to write output to file described by fileName, writes all edges in
-    the min-cut. Then returns if it was successful as boolean value.
+    the min-cut. Flow of the graph edges is split back to the loaded edges
+    they were merged from, so the loaded edges are written. If the solve was
+    stopped before the maximal flow was found, edges of the best cut found
+    are written (they don't have to be saturated). Then returns if it was
+    successful as boolean value.
    ____________________________________________________________________________
 */
 int writeToOutputFile(char *fileName, graph *graphPointer) {
     int i;
-    int j;
+    int k;
+    int exact;
     graphEdge *edgePointer;
     graphNode *sourceNode;
     graphNode *targetNode;
@@ -310,25 +459,30 @@ int writeToOutputFile(char *fileName, graph *graphPointer) {
         return FAILURE;
     }
 
+    graphSplitFlow(graphPointer);
+    graphMarkSourceSide(graphPointer);
+    exact = graphIsExact(graphPointer);
+
     fprintf(output,"%s", EDGES_ID);
-    for (i = 0; i < graphPointer->edges->size; i++) {
-        for (j = 0; j < graphPointer->edges->array[i]->filledItems; j++) {
-            edgePointer = arrayListGetPointer(graphPointer->edges->array[i], j);
-            if (edgePointer) {
-                /* get rid of reverse edges, and edges which don't have fulfilled capacity */
-                if (edgePointer->capacity == 0 || edgePointer->capacity != edgePointer->flow) continue;
-                sourceNode = hashTableGetElement(edgePointer->source, graphPointer->nodes);
-                targetNode = hashTableGetElement(edgePointer->target, graphPointer->nodes);
-                /* nodes which are "to the left" from the min-cut have level != -1,
-                  nodes which are "to the right" from the min-cut have level == -1,
-                  so we want to write just the edges, which have source in the
-                  left side, and target in the right side or edges which have source in the right side and
-                  target in the left side*/
-
-                if ((sourceNode->level != -1 && targetNode->level == -1) || (sourceNode->level == -1
-                                                                             && targetNode->level != -1)) {
-                    arrayListAdd(list, edgePointer);
-                }
+    for (i = 0; i < graphPointer->arcCount; i++) {
+        sourceNode = &graphPointer->nodeList[graphPointer->head[REVERSE(i)]];
+        targetNode = &graphPointer->nodeList[graphPointer->head[i]];
+        /* arcs without members are skipped by the loop */
+        for (k = graphPointer->firstMember[i]; k < graphPointer->firstMember[i + 1]; k++) {
+            edgePointer = graphPointer->memberList[k];
+
+            /* get rid of edges which don't have fulfilled capacity */
+            if (edgePointer->capacity == 0 || !graphUsesEdge(graphPointer, edgePointer)
+                || (exact && !isSaturated(edgePointer))) continue;
+            /* nodes which are "to the left" from the min-cut have level != -1,
+              nodes which are "to the right" from the min-cut have level == -1,
+              so we want to write just the edges, which have source in the
+              left side, and target in the right side or edges which have source in the right side and
+              target in the left side, undirected edges cross the min-cut in both directions */
+
+            if ((sourceNode->level != -1 && targetNode->level == -1)
+                || ((exact || edgePointer->isUndirected) && sourceNode->level == -1 && targetNode->level != -1)) {
+                arrayListAdd(list, edgePointer);
             }
         }
     }
@@ -337,7 +491,7 @@ int writeToOutputFile(char *fileName, graph *graphPointer) {
     for (i = 0; i < list->filledItems; i++) {
         edgePointer = arrayListGetPointer(list, i);
         validity = edgePointer->isValid == 'Y' ? VALID : INVALID;
-        fprintf(output, "%d,%d,%d,%ld,%s,%s", edgePointer->id, edgePointer->source, edgePointer->target,
+        fprintf(output, "%d,%d,%d,%.15g,%s,%s", edgePointer->id, edgePointer->source, edgePointer->target,
                 edgePointer->capacity, validity, edgePointer->wkt);
     }
     freeArrayList(&list);
@@ -346,6 +500,265 @@ int writeToOutputFile(char *fileName, graph *graphPointer) {
     return SUCCESS;
 }
 
+/* ____________________________________________________________________________
+
+    void putLittleEndian(unsigned char *buffer, unsigned long value,
+                         int bytes)
+
+    Stores lowest bytes of the value into the buffer, the lowest byte
+    first. Bytes above the width of long are zeros.
+   ____________________________________________________________________________
+*/
+static void putLittleEndian(unsigned char *buffer, unsigned long value, int bytes) {
+    int i;
+
+    for (i = 0; i < bytes; i++) {
+        buffer[i] = (unsigned char) (value & 0xFF);
+        value >>= 8;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void putDouble(unsigned char *buffer, double value)
+
+    Stores IEEE 754 double into the buffer in little-endian byte order.
+   ____________________________________________________________________________
+*/
+static void putDouble(unsigned char *buffer, double value) {
+    int i;
+    unsigned long one = 1;
+    unsigned char bytes[sizeof(double)];
+
+    memcpy(bytes, &value, sizeof(double));
+    for (i = 0; i < (int) sizeof(double); i++) {
+        buffer[i] = *(unsigned char *) &one ? bytes[i] : bytes[sizeof(double) - 1 - i];
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int flowRecordWrite(FILE *file, unsigned char *buffer, size_t *used,
+                        size_t size)
+
+    Makes room for a record of size bytes at the end of the buffer, the
+    buffer is written into the file when it's full. Returns boolean value
+    if it was successful.
+   ____________________________________________________________________________
+*/
+static int flowRecordWrite(FILE *file, unsigned char *buffer, size_t *used, size_t size) {
+    if (*used + size <= FLOWS_BUFFER_SIZE) return SUCCESS;
+
+    if (fwrite(buffer, 1, *used, file) != *used) return FAILURE;
+    *used = 0;
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int writeFlowFile(char *fileName, graph *graphPointer,
+                      hashTable *edgesTable, int csv)
+
+    Writes flow of every loaded edge of the table and ids of the nodes on
+    the source side of the cut into the file in one pass. Edges which
+    were pruned from the graph have no flow and pruned nodes are never
+    on the source side. Binary file is little-endian
+    and fixed-width, so it can be mapped and read as arrays: header of
+    FLOWS_HEADER_SIZE bytes (magic, version, record size, edge count,
+    offset of the edges, node count, offset of the nodes, the flow and
+    whether it's maximal), then records of the edges (int32 id, uint32
+    flags FLOWS_VALID and FLOWS_UNDIRECTED, float64 flow, negative for
+    undirected edges used from target to source) and int32 ids of the
+    nodes. With csv the same is written as text rows "type,id,flow" for
+    debugging. Returns SUCCESS or FAILURE if error occurred.
+   ____________________________________________________________________________
+*/
+int writeFlowFile(char *fileName, graph *graphPointer, hashTable *edgesTable, int csv) {
+    int i;
+    int j;
+    int flags;
+    int written = SUCCESS;
+    unsigned long nodeCount = 0;
+    size_t used = 0;
+    double maxFlow;
+    unsigned char *buffer;
+    graphEdge *edgePointer;
+    FILE *output;
+
+    if (!fileName || !graphPointer || !edgesTable) return FAILURE;
+
+    buffer = malloc(FLOWS_BUFFER_SIZE);
+    if (!buffer) return FAILURE;
+
+    output = fopen(fileName, csv ? "w" : "wb");
+    if (!output) {
+        free(buffer);
+        return FAILURE;
+    }
+
+    graphSplitFlow(graphPointer);
+    graphMarkSourceSide(graphPointer);
+    for (i = 0; i < graphPointer->nodeCount; i++) {
+        if (graphPointer->nodeList[i].level != -1 && graphPointer->nodeList[i].id != -1) nodeCount++;
+    }
+    maxFlow = graphPointer->flowType == FLOW_REAL ? graphPointer->maxFlow.real
+                                                  : (double) graphPointer->maxFlow.integer;
+
+    /* text goes through the buffer of the stream, binary records through the own buffer */
+    if (csv) {
+        setvbuf(output, NULL, _IOFBF, FLOWS_BUFFER_SIZE);
+        fprintf(output, FLOWS_CSV_HEADER);
+    } else {
+        memset(buffer, 0, FLOWS_HEADER_SIZE);
+        memcpy(buffer, FLOWS_MAGIC, strlen(FLOWS_MAGIC));
+        putLittleEndian(buffer + 8, FLOWS_VERSION, 4);
+        putLittleEndian(buffer + 12, FLOWS_RECORD_SIZE, 4);
+        putLittleEndian(buffer + 16, (unsigned long) edgesTable->filledItems, 8);
+        putLittleEndian(buffer + 24, FLOWS_HEADER_SIZE, 8);
+        putLittleEndian(buffer + 32, nodeCount, 8);
+        putLittleEndian(buffer + 40, FLOWS_HEADER_SIZE + FLOWS_RECORD_SIZE * (unsigned long) edgesTable->filledItems, 8);
+        putDouble(buffer + 48, maxFlow);
+        putLittleEndian(buffer + 56, (unsigned long) graphIsExact(graphPointer), 4);
+        used = FLOWS_HEADER_SIZE;
+    }
+
+    for (i = 0; i < edgesTable->size && written; i++) {
+        for (j = 0; j < edgesTable->array[i]->filledItems && written; j++) {
+            edgePointer = arrayListGetPointer(edgesTable->array[i], j);
+            if (csv) {
+                fprintf(output, "edge,%d,%.15g\n", edgePointer->id, edgePointer->flow);
+                continue;
+            }
+
+            written = flowRecordWrite(output, buffer, &used, FLOWS_RECORD_SIZE);
+            flags = (edgePointer->isValid == 'Y' ? FLOWS_VALID : 0) | (edgePointer->isUndirected ? FLOWS_UNDIRECTED : 0);
+            putLittleEndian(buffer + used, (unsigned long) edgePointer->id, 4);
+            putLittleEndian(buffer + used + 4, (unsigned long) flags, 4);
+            putDouble(buffer + used + 8, edgePointer->flow);
+            used += FLOWS_RECORD_SIZE;
+        }
+    }
+
+    for (i = 0; i < graphPointer->nodeCount && written; i++) {
+        if (graphPointer->nodeList[i].level == -1 || graphPointer->nodeList[i].id == -1) continue;
+        if (csv) {
+            fprintf(output, "node,%d,\n", graphPointer->nodeList[i].id);
+            continue;
+        }
+
+        written = flowRecordWrite(output, buffer, &used, FLOWS_NODE_SIZE);
+        putLittleEndian(buffer + used, (unsigned long) graphPointer->nodeList[i].id, 4);
+        used += FLOWS_NODE_SIZE;
+    }
+
+    if (written && used > 0) written = fwrite(buffer, 1, used, output) == used;
+    written = fclose(output) == 0 && written;
+    free(buffer);
+    return written ? SUCCESS : FAILURE;
+}
+
+/* ____________________________________________________________________________
+
+    int parseTerminal(char *text, graphTerminal *terminal, char separator,
+                      char **end)
+
+    Parses one terminal, id of the node optionally followed by separator
+    and positive limit of its flow (0 means no limit). End is set after
+    the parsed text. Returns boolean value if it was successful.
+   ____________________________________________________________________________
+*/
+static int parseTerminal(char *text, graphTerminal *terminal, char separator, char **end) {
+    terminal->id = strtol(text, end, 10);
+    terminal->limit = 0;
+    if (*end == text) return FAILURE;
+
+    if (**end == separator) {
+        text = *end + 1;
+        terminal->limit = strtod(text, end);
+        if (*end == text || !(terminal->limit > 0)) return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    graphTerminal *loadTerminals(char *text, int *count)
+
+    Loads sources or targets of the query. Text is a list of terminals
+    separated by commas, every terminal is id of the node optionally
+    followed by colon and limit of its flow (12,15:40). If the text isn't
+    such a list, it's name of a file with one terminal per line, id and
+    optional limit separated by comma, lines which don't start with a
+    number (header) are skipped. Returns array of the terminals and sets
+    count, or returns NULL if no terminal was found or error occurred.
+   ____________________________________________________________________________
+*/
+graphTerminal *loadTerminals(char *text, int *count) {
+    int size = INITIAL_SIZE;
+    char *end;
+    char *list = text;
+    char *string;
+    graphTerminal terminal;
+    graphTerminal *terminals;
+    graphTerminal *temp;
+    FILE *inputFile;
+
+    if (!text || !count) return NULL;
+
+    *count = 0;
+    terminals = malloc(size * sizeof(graphTerminal));
+    if (!terminals) return NULL;
+
+    while (parseTerminal(list, &terminal, ':', &end)) {
+        if (*count == size) {
+            size *= INCREMENT;
+            temp = realloc(terminals, size * sizeof(graphTerminal));
+            if (!temp) break;
+            terminals = temp;
+        }
+        terminals[(*count)++] = terminal;
+
+        if (*end == '\0') return terminals;
+        if (*end != ',') break;
+        list = end + 1;
+    }
+
+    /* the text is not a list, so it's read as a file */
+    *count = 0;
+    inputFile = fopen(text, "r");
+    string = malloc(MAXLENGTH);
+    if (!inputFile || !string) {
+        if (inputFile) fclose(inputFile);
+        free(string);
+        free(terminals);
+        return NULL;
+    }
+
+    while (fgets(string, MAXLENGTH, inputFile)) {
+        if (!parseTerminal(string, &terminal, ',', &end)) continue;
+
+        if (*count == size) {
+            size *= INCREMENT;
+            temp = realloc(terminals, size * sizeof(graphTerminal));
+            if (!temp) {
+                *count = 0;
+                break;
+            }
+            terminals = temp;
+        }
+        terminals[(*count)++] = terminal;
+    }
+
+    free(string);
+    fclose(inputFile);
+    if (*count == 0) {
+        free(terminals);
+        return NULL;
+    }
+    return terminals;
+}
+
 /* ____________________________________________________________________________
 
     int compareEdgeById(const void *a, const void *b)
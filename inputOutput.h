@@ -7,6 +7,16 @@
 #define EDGES_ID "id,source,target,capacity,isvalid,WKT\n"
 #define VALID "True"
 #define INVALID "False"
+#define EDGE_ROW_ESTIMATE 64
+#define FLOWS_MAGIC "FLOWBIN1"
+#define FLOWS_VERSION 1
+#define FLOWS_HEADER_SIZE 64
+#define FLOWS_RECORD_SIZE 16
+#define FLOWS_NODE_SIZE 4
+#define FLOWS_BUFFER_SIZE (1 << 20)
+#define FLOWS_VALID 1
+#define FLOWS_UNDIRECTED 2
+#define FLOWS_CSV_HEADER "type,id,flow\n"
 
 #include "structs.h"
 
@@ -19,10 +29,15 @@
 graphNode *createNode(char *input);
 void freeGraphNode(graphNode **nodePointer);
 void freeGraphEdge(graphEdge **edgePointer);
-graphEdge *createEdge(char *input, int workWithInvalid);
+graphEdge *createEdge(char *input, int workWithInvalid, int undirected);
 hashTable *loadNodes(char *inputName);
-hashTable *loadEdges(char *inputName, int workWithInvalid, int tableSize);
+hashTable *loadEdges(char *inputName, int workWithInvalid, int undirected, int tableSize);
+long copyLine(const char *data, long length, long position, char *line);
+hashTable *parseNodes(const char *data, long length);
+hashTable *parseEdges(const char *data, long length, int workWithInvalid, int undirected);
 int writeToOutputFile(char *fileName, graph *graphPointer);
+int writeFlowFile(char *fileName, graph *graphPointer, hashTable *edgesTable, int csv);
+graphTerminal *loadTerminals(char *text, int *count);
 int compareEdgeById(const void *a, const void *b);
 int compareEdgeBySource(const void *a, const void *b);
 
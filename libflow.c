@@ -0,0 +1,251 @@
+/* ____________________________________________________________________________
+
+    Module libflow.c
+    This module implements libflow.h, the interface of the solver for
+    programs which link it as a library instead of running flow.exe. Graph
+    handle owns loaded nodes, edges and the graph built over all of them
+    (not pruned, because source and target differ between solves). Solver
+    handle owns a view of the graph (see graphCreateView) with its own
+    residual capacities, which are reset before every solve. Everything
+    lives in the handles, nothing is kept in global variables.
+   ____________________________________________________________________________
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "libflow.h"
+#include "graph.h"
+#include "hashTable.h"
+#include "loader.h"
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+struct flowGraph {
+    hashTable *nodesTable;
+    hashTable *edgesTable;
+    graph *graphPointer;
+};
+
+struct flowSolver {
+    graph *view;
+    int engine;
+    int solved;
+};
+
+/* ____________________________________________________________________________
+
+    flowGraph *createFlowGraph(hashTable *nodesTable, hashTable *edgesTable)
+
+    Builds graph over loaded tables, the handle takes them over. Tables
+    are freed if the graph can't be built. Returns pointer to the handle
+    or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+static flowGraph *createFlowGraph(hashTable *nodesTable, hashTable *edgesTable) {
+    flowGraph *flowGraphPointer = NULL;
+
+    if (nodesTable && edgesTable) flowGraphPointer = malloc(sizeof(flowGraph));
+    if (flowGraphPointer) {
+        flowGraphPointer->nodesTable = nodesTable;
+        flowGraphPointer->edgesTable = edgesTable;
+        flowGraphPointer->graphPointer = createNewGraph(nodesTable, edgesTable, ORDER_RCM);
+        if (flowGraphPointer->graphPointer) return flowGraphPointer;
+    }
+
+    free(flowGraphPointer);
+    freeHashTable(&nodesTable);
+    freeHashTable(&edgesTable);
+    return NULL;
+}
+
+/* ____________________________________________________________________________
+
+    flowGraph *loadFlowGraph(const char *nodesName, const char *edgesName,
+                             int flags)
+
+    Loads node file and edge file and builds graph over them. Flags are
+    LIBFLOW_INVALID_EDGES (edges with isvalid False are used too) and
+    LIBFLOW_UNDIRECTED (every edge carries its capacity in both
+    directions). Returns pointer to the graph or NULL if some of the files
+    is invalid or if error occurred.
+   ____________________________________________________________________________
+*/
+flowGraph *loadFlowGraph(const char *nodesName, const char *edgesName, int flags) {
+    hashTable *nodesTable = NULL;
+    hashTable *edgesTable = NULL;
+
+    loadFiles((char *) nodesName, (char *) edgesName, (flags & LIBFLOW_INVALID_EDGES) != 0,
+              (flags & LIBFLOW_UNDIRECTED) != 0, &nodesTable, &edgesTable);
+    return createFlowGraph(nodesTable, edgesTable);
+}
+
+/* ____________________________________________________________________________
+
+    flowGraph *parseFlowGraph(const char *nodes, long nodesLength,
+                              const char *edges, long edgesLength,
+                              int flags)
+
+    Works like loadFlowGraph, but nodes and edges are read from buffers
+    of given length, which have the same format as the files.
+   ____________________________________________________________________________
+*/
+flowGraph *parseFlowGraph(const char *nodes, long nodesLength, const char *edges, long edgesLength, int flags) {
+    hashTable *nodesTable;
+    hashTable *edgesTable = NULL;
+
+    nodesTable = parseNodes(nodes, nodesLength);
+    if (nodesTable) {
+        edgesTable = parseEdges(edges, edgesLength, (flags & LIBFLOW_INVALID_EDGES) != 0,
+                                (flags & LIBFLOW_UNDIRECTED) != 0);
+    }
+    return createFlowGraph(nodesTable, edgesTable);
+}
+
+/* ____________________________________________________________________________
+
+    int flowGraphNodeCount(flowGraph *flowGraphPointer)
+
+    Returns number of nodes of the graph.
+   ____________________________________________________________________________
+*/
+int flowGraphNodeCount(flowGraph *flowGraphPointer) {
+    return flowGraphPointer ? flowGraphPointer->graphPointer->nodeCount : 0;
+}
+
+/* ____________________________________________________________________________
+
+    void freeFlowGraph(flowGraph **flowGraphPointer)
+
+    Frees the graph and everything it owns. All solvers of the graph must
+    be freed before. Sets the pointer to NULL.
+   ____________________________________________________________________________
+*/
+void freeFlowGraph(flowGraph **flowGraphPointer) {
+    if (!flowGraphPointer || !*flowGraphPointer) return;
+
+    freeNewGraph(&(*flowGraphPointer)->graphPointer);
+    freeHashTable(&(*flowGraphPointer)->nodesTable);
+    freeHashTable(&(*flowGraphPointer)->edgesTable);
+    free(*flowGraphPointer);
+    *flowGraphPointer = NULL;
+}
+
+/* ____________________________________________________________________________
+
+    flowSolver *createFlowSolver(flowGraph *flowGraphPointer, int engine)
+
+    Creates solver of the graph. Engine is LIBFLOW_ENGINE_DINIC,
+    LIBFLOW_ENGINE_DYNAMIC (blocking flow by dynamic trees) or
+    LIBFLOW_ENGINE_PLANAR (dual shortest paths of planar undirected
+    graphs, Dinics algorithm otherwise). Returns pointer to the solver or
+    NULL if error occurred.
+   ____________________________________________________________________________
+*/
+flowSolver *createFlowSolver(flowGraph *flowGraphPointer, int engine) {
+    flowSolver *solver;
+
+    if (!flowGraphPointer || (engine != LIBFLOW_ENGINE_DINIC && engine != LIBFLOW_ENGINE_DYNAMIC
+                              && engine != LIBFLOW_ENGINE_PLANAR)) return NULL;
+
+    solver = malloc(sizeof(flowSolver));
+    if (!solver) return NULL;
+
+    solver->view = graphCreateView(flowGraphPointer->graphPointer);
+    solver->engine = ENGINE_DINIC;
+    if (engine == LIBFLOW_ENGINE_DYNAMIC) solver->engine = ENGINE_DYNAMIC;
+    if (engine == LIBFLOW_ENGINE_PLANAR) solver->engine = ENGINE_PLANAR;
+    solver->solved = 0;
+    if (!solver->view) {
+        free(solver);
+        return NULL;
+    }
+
+    return solver;
+}
+
+/* ____________________________________________________________________________
+
+    int flowSolverRun(flowSolver *solver, int source, int target)
+
+    Finds maximal flow between nodes with ids source and target, state of
+    the previous solve is reset first. Returns FAILURE if some of the nodes
+    is not in the graph or if they are the same.
+   ____________________________________________________________________________
+*/
+int flowSolverRun(flowSolver *solver, int source, int target) {
+    if (!solver) return FAILURE;
+
+    graphResetResidual(solver->view);
+    solver->solved = source != target
+                     && graphMaxFlow(solver->view, source, target, solver->engine, 0, 0);
+    return solver->solved ? SUCCESS : FAILURE;
+}
+
+/* ____________________________________________________________________________
+
+    double flowSolverValue(flowSolver *solver)
+
+    Returns the flow found by the last successful solve or 0.
+   ____________________________________________________________________________
+*/
+double flowSolverValue(flowSolver *solver) {
+    if (!solver || !solver->solved) return 0;
+
+    if (solver->view->flowType == FLOW_REAL) return solver->view->maxFlow.real;
+    return (double) solver->view->maxFlow.integer;
+}
+
+/* ____________________________________________________________________________
+
+    char *flowSolverFormat(flowSolver *solver, char *buffer)
+
+    Writes the flow of the last successful solve into buffer (at least
+    LIBFLOW_BUFFER_SIZE characters) without loss of precision. Returns
+    the buffer.
+   ____________________________________________________________________________
+*/
+char *flowSolverFormat(flowSolver *solver, char *buffer) {
+    flowValue zero;
+
+    if (!solver) {
+        strcpy(buffer, "0");
+        return buffer;
+    }
+
+    memset(&zero, 0, sizeof(flowValue));
+    return graphFormatFlow(solver->view, solver->solved ? solver->view->maxFlow : zero, buffer);
+}
+
+/* ____________________________________________________________________________
+
+    int flowSolverCut(flowSolver *solver, int *ids, int size)
+
+    Writes ids of the edges of the minimal cut found by the last successful
+    solve into ids array, at most size of them. Returns number of the cut
+    edges (ids are sorted if all of them fit) or -1 if nothing was solved.
+   ____________________________________________________________________________
+*/
+int flowSolverCut(flowSolver *solver, int *ids, int size) {
+    if (!solver || !solver->solved) return -1;
+
+    return graphCutEdges(solver->view, ids, size < 0 ? 0 : size);
+}
+
+/* ____________________________________________________________________________
+
+    void freeFlowSolver(flowSolver **solver)
+
+    Frees the solver and sets the pointer to NULL.
+   ____________________________________________________________________________
+*/
+void freeFlowSolver(flowSolver **solver) {
+    if (!solver || !*solver) return;
+
+    freeGraphView(&(*solver)->view);
+    free(*solver);
+    *solver = NULL;
+}
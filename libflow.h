@@ -0,0 +1,48 @@
+#ifndef SEMESTRALKA_LIBFLOW_H
+#define SEMESTRALKA_LIBFLOW_H
+
+/* ____________________________________________________________________________
+
+    Header libflow.h
+    Public interface of libflow shared library. Graph and solver are
+    opaque handles. One graph can be shared by any number of solvers, every
+    solver keeps its own state and can be used by one thread at a time, so
+    several threads can solve the same graph at once. The library has no
+    global state.
+   ____________________________________________________________________________
+*/
+
+#define LIBFLOW_INVALID_EDGES 1
+#define LIBFLOW_UNDIRECTED 2
+#define LIBFLOW_ENGINE_DINIC 0
+#define LIBFLOW_ENGINE_DYNAMIC 1
+#define LIBFLOW_ENGINE_PLANAR 2
+#define LIBFLOW_BUFFER_SIZE 32
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct flowGraph flowGraph;
+typedef struct flowSolver flowSolver;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+flowGraph *loadFlowGraph(const char *nodesName, const char *edgesName, int flags);
+flowGraph *parseFlowGraph(const char *nodes, long nodesLength, const char *edges, long edgesLength, int flags);
+int flowGraphNodeCount(flowGraph *flowGraphPointer);
+void freeFlowGraph(flowGraph **flowGraphPointer);
+flowSolver *createFlowSolver(flowGraph *flowGraphPointer, int engine);
+int flowSolverRun(flowSolver *solver, int source, int target);
+double flowSolverValue(flowSolver *solver);
+char *flowSolverFormat(flowSolver *solver, char *buffer);
+int flowSolverCut(flowSolver *solver, int *ids, int size);
+void freeFlowSolver(flowSolver **solver);
+
+#endif
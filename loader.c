@@ -0,0 +1,268 @@
+/* ____________________________________________________________________________
+
+    Module loader.c
+    This module loads node and edge files at the same time. Node file is
+    loaded by its own thread. Edge file is read in chunks by reader thread
+    and the chunks are passed through bounded queue to the calling thread,
+    which parses them into edges, so reading of the file and parsing run
+    at the same time too. Endpoints of the edges are checked against the
+    nodes later, when the graph is pruned and built (see prune.c), because
+    only then both tables are complete. If threads are not available, the
+    files are loaded one after another.
+   ____________________________________________________________________________
+*/
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#include <pthread.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "loader.h"
+#include "inputOutput.h"
+
+#ifdef __unix__
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct {
+    char *nodesName;
+    hashTable *nodesTable;
+} loaderNodes;
+
+typedef struct {
+    FILE *inputFile;
+    char *slots[LOADER_QUEUE_SLOTS];
+    char *rest;
+    int lengths[LOADER_QUEUE_SLOTS];
+    int first;
+    int count;
+    int finished;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+} loaderQueue;
+
+/* ____________________________________________________________________________
+
+    void *loaderNodesThread(void *argument)
+
+    Loads node file into the nodes table of loaderNodes struct.
+   ____________________________________________________________________________
+*/
+static void *loaderNodesThread(void *argument) {
+    loaderNodes *nodes = argument;
+
+    nodes->nodesTable = loadNodes(nodes->nodesName);
+    return NULL;
+}
+
+/* ____________________________________________________________________________
+
+    void *loaderReaderThread(void *argument)
+
+    Reads the rest of the edge file into free slots of the loaderQueue.
+    Every slot ends with whole line, the part of the last line which didn't
+    fit is kept aside and it's moved to the beginning of the next slot.
+    When the file ends, finished flag is set.
+   ____________________________________________________________________________
+*/
+static void *loaderReaderThread(void *argument) {
+    int slot;
+    int length;
+    int carry = 0;
+    int end;
+    loaderQueue *queue = argument;
+    char *data;
+
+    while (1) {
+        pthread_mutex_lock(&queue->lock);
+        while (queue->count == LOADER_QUEUE_SLOTS) pthread_cond_wait(&queue->notFull, &queue->lock);
+        slot = (queue->first + queue->count) % LOADER_QUEUE_SLOTS;
+        pthread_mutex_unlock(&queue->lock);
+
+        data = queue->slots[slot];
+        memcpy(data, queue->rest, carry);
+        length = carry + (int) fread(data + carry, 1, LOADER_CHUNK_SIZE - carry, queue->inputFile);
+        if (length == 0) break;
+
+        /* slot is cut after the last new line, unless the file ended */
+        end = length;
+        if (!feof(queue->inputFile)) {
+            while (end > 0 && data[end - 1] != '\n') end--;
+            if (end == 0) end = length;
+        }
+        carry = length - end;
+        memcpy(queue->rest, data + end, carry);
+
+        pthread_mutex_lock(&queue->lock);
+        queue->lengths[slot] = end;
+        queue->count++;
+        pthread_cond_signal(&queue->notEmpty);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    queue->finished = 1;
+    pthread_cond_signal(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->lock);
+    return NULL;
+}
+
+/* ____________________________________________________________________________
+
+    void loaderParseSlot(char *data, int length, int workWithInvalid,
+                         int undirected, hashTable *edgesTable)
+
+    Parses all lines of the slot into edges and adds them into edgesTable,
+    edges with id which was already loaded are dropped.
+   ____________________________________________________________________________
+*/
+static void loaderParseSlot(char *data, int length, int workWithInvalid, int undirected, hashTable *edgesTable) {
+    long position = 0;
+    char line[MAXLENGTH];
+    graphEdge *edgePointer;
+
+    while (position < length) {
+        position = copyLine(data, length, position, line);
+        edgePointer = createEdge(line, workWithInvalid, undirected);
+        if (edgePointer && !hashTableAddElement(edgePointer, edgePointer->id, edgesTable)) {
+            freeGraphEdge(&edgePointer);
+        }
+    }
+}
+
+/* ____________________________________________________________________________
+
+    hashTable *loaderEdges(char *edgesName, int workWithInvalid,
+                           int undirected)
+
+    Loads edge file, the file is read by reader thread and parsed by the
+    calling thread. Size of the hashTable is estimated from size of the
+    file. Returns pointer to the hashTable or NULL if the file is invalid
+    or if error occurred.
+   ____________________________________________________________________________
+*/
+static hashTable *loaderEdges(char *edgesName, int workWithInvalid, int undirected) {
+    int i;
+    int slot;
+    long fileSize;
+    char header[MAXLENGTH];
+    pthread_t reader;
+    loaderQueue queue;
+    hashTable *edgesTable = NULL;
+
+    if (!edgesName) return NULL;
+
+    memset(&queue, 0, sizeof(loaderQueue));
+    queue.inputFile = fopen(edgesName, "r");
+    if (!queue.inputFile) return NULL;
+
+    fseek(queue.inputFile, 0, SEEK_END);
+    fileSize = ftell(queue.inputFile);
+    rewind(queue.inputFile);
+
+    if (!fgets(header, MAXLENGTH, queue.inputFile) || strncmp(EDGES_ID, header, strlen(EDGES_ID)) != 0) {
+        fclose(queue.inputFile);
+        return NULL;
+    }
+
+    for (i = 0; i < LOADER_QUEUE_SLOTS; i++) {
+        queue.slots[i] = malloc(LOADER_CHUNK_SIZE);
+        if (!queue.slots[i]) break;
+    }
+    queue.rest = malloc(LOADER_CHUNK_SIZE);
+
+    edgesTable = createHashTable((int) (fileSize / EDGE_ROW_ESTIMATE) + INITIAL_SIZE, sizeof(graphEdge));
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_cond_init(&queue.notEmpty, NULL);
+    pthread_cond_init(&queue.notFull, NULL);
+
+    if (i < LOADER_QUEUE_SLOTS || !queue.rest || !edgesTable || pthread_create(&reader, NULL, loaderReaderThread, &queue)) {
+        freeHashTable(&edgesTable);
+    } else {
+        while (1) {
+            pthread_mutex_lock(&queue.lock);
+            while (queue.count == 0 && !queue.finished) pthread_cond_wait(&queue.notEmpty, &queue.lock);
+            if (queue.count == 0) {
+                pthread_mutex_unlock(&queue.lock);
+                break;
+            }
+            slot = queue.first;
+            pthread_mutex_unlock(&queue.lock);
+
+            loaderParseSlot(queue.slots[slot], queue.lengths[slot], workWithInvalid, undirected, edgesTable);
+
+            pthread_mutex_lock(&queue.lock);
+            queue.first = (queue.first + 1) % LOADER_QUEUE_SLOTS;
+            queue.count--;
+            pthread_cond_signal(&queue.notFull);
+            pthread_mutex_unlock(&queue.lock);
+        }
+        pthread_join(reader, NULL);
+    }
+
+    pthread_cond_destroy(&queue.notFull);
+    pthread_cond_destroy(&queue.notEmpty);
+    pthread_mutex_destroy(&queue.lock);
+    for (i = 0; i < LOADER_QUEUE_SLOTS; i++) free(queue.slots[i]);
+    free(queue.rest);
+    fclose(queue.inputFile);
+
+    return edgesTable;
+}
+
+/* ____________________________________________________________________________
+
+    void loadFiles(char *nodesName, char *edgesName, int workWithInvalid,
+                   int undirected, hashTable **nodesTable,
+                   hashTable **edgesTable)
+
+    Loads node file and edge file at the same time (see loadNodes and
+    loadEdges for the meaning of the parameters). Tables are set to NULL
+    if the file is invalid. If the node thread can't be started, the files
+    are loaded one after another.
+   ____________________________________________________________________________
+*/
+void loadFiles(char *nodesName, char *edgesName, int workWithInvalid, int undirected, hashTable **nodesTable,
+               hashTable **edgesTable) {
+    pthread_t nodesThread;
+    loaderNodes nodes;
+
+    nodes.nodesName = nodesName;
+    nodes.nodesTable = NULL;
+
+    if (pthread_create(&nodesThread, NULL, loaderNodesThread, &nodes)) {
+        *nodesTable = loadNodes(nodesName);
+        *edgesTable = *nodesTable ? loadEdges(edgesName, workWithInvalid, undirected, (*nodesTable)->size) : NULL;
+        return;
+    }
+
+    *edgesTable = loaderEdges(edgesName, workWithInvalid, undirected);
+    pthread_join(nodesThread, NULL);
+    *nodesTable = nodes.nodesTable;
+}
+
+#else
+
+/* ____________________________________________________________________________
+
+    void loadFiles(char *nodesName, char *edgesName, int workWithInvalid,
+                   int undirected, hashTable **nodesTable,
+                   hashTable **edgesTable)
+
+    Threads are not available on this platform, so node file and edge file
+    are loaded one after another.
+   ____________________________________________________________________________
+*/
+void loadFiles(char *nodesName, char *edgesName, int workWithInvalid, int undirected, hashTable **nodesTable,
+               hashTable **edgesTable) {
+    *nodesTable = loadNodes(nodesName);
+    *edgesTable = *nodesTable ? loadEdges(edgesName, workWithInvalid, undirected, (*nodesTable)->size) : NULL;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef SEMESTRALKA_LOADER_H
+#define SEMESTRALKA_LOADER_H
+
+#include "structs.h"
+
+#define LOADER_CHUNK_SIZE 65536
+#define LOADER_QUEUE_SLOTS 4
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+void loadFiles(char *nodesName, char *edgesName, int workWithInvalid, int undirected, hashTable **nodesTable,
+               hashTable **edgesTable);
+
+#endif
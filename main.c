@@ -9,6 +9,13 @@
 #include "arrayList.h"
 #include "hashTable.h"
 #include "graph.h"
+#include "prune.h"
+#include "partition.h"
+#include "loader.h"
+#include "server.h"
+#include "vital.h"
+#include "paths.h"
+#include "verify.h"
 
 #define MAXLENGTH 4096
 #define VALIDATE_INDEX(x, y) (((x) != (-1)) && (((x) + 1) < (y)))
@@ -27,6 +34,9 @@
 
 hashTable *loadedNodes = NULL;
 hashTable *loadedEdges = NULL;
+hashTable *coreNodes = NULL;
+graphTerminal *sources = NULL;
+graphTerminal *targets = NULL;
 graph *graphPointer;
 
 /* ____________________________________________________________________________
@@ -39,7 +49,58 @@ graph *graphPointer;
 void cleanEverything() {
     if (loadedEdges) freeHashTable(&loadedEdges);
     if (loadedNodes) freeHashTable(&loadedNodes);
+    if (coreNodes) freeHashTable(&coreNodes);
     if (graphPointer) freeNewGraph(&graphPointer);
+    free(sources);
+    free(targets);
+}
+
+/* ____________________________________________________________________________
+
+    int compareTerminalId(const void *a, const void *b)
+
+    Auxiliary function which defines how two terminals should be compared
+    by id. Necessary for using qsort.
+   ____________________________________________________________________________
+ */
+int compareTerminalId(const void *a, const void *b) {
+    int first = ((graphTerminal *) a)->id;
+    int second = ((graphTerminal *) b)->id;
+
+    return first < second ? -1 : first > second;
+}
+
+/* ____________________________________________________________________________
+
+    int checkTerminals(graphTerminal *terminals, int count,
+                       graphTerminal *others, int otherCount)
+
+    Returns boolean value if all terminals are loaded nodes and if no node
+    is given twice, neither among the terminals nor among the terminals
+    and the others (sources, when targets are checked).
+   ____________________________________________________________________________
+ */
+int checkTerminals(graphTerminal *terminals, int count, graphTerminal *others, int otherCount) {
+    int i;
+    int valid = SUCCESS;
+    graphTerminal *all;
+
+    for (i = 0; i < count; i++) {
+        if (!hashTableContains(terminals[i].id, loadedNodes)) return FAILURE;
+    }
+
+    all = malloc((count + otherCount) * sizeof(graphTerminal));
+    if (!all) return FAILURE;
+    memcpy(all, terminals, count * sizeof(graphTerminal));
+    if (otherCount) memcpy(all + count, others, otherCount * sizeof(graphTerminal));
+
+    qsort(all, count + otherCount, sizeof(graphTerminal), compareTerminalId);
+    for (i = 1; i < count + otherCount; i++) {
+        if (all[i].id == all[i - 1].id) valid = FAILURE;
+    }
+
+    free(all);
+    return valid;
 }
 
 /* ____________________________________________________________________________
@@ -60,6 +121,52 @@ int findInInput(const int argc, char *argv[], const char *text) {
     }
     return -1;
 }
+/* ____________________________________________________________________________
+
+    void printMaxFlow(const char *subject)
+
+    Prints the flow of the graph after subject, or its lower and upper
+    bound if the solve was stopped before the maximal flow was found.
+   ____________________________________________________________________________
+ */
+void printMaxFlow(const char *subject) {
+    char flowText[FLOW_BUFFER_SIZE];
+    char boundText[FLOW_BUFFER_SIZE];
+
+    graphFormatFlow(graphPointer, graphPointer->maxFlow, flowText);
+    if (graphIsExact(graphPointer)) {
+        printf("%s is |x| = %s.\n", subject, flowText);
+    } else {
+        graphFormatFlow(graphPointer, graphPointer->upperBound, boundText);
+        printf("%s is %s <= |x| <= %s.\n", subject, flowText, boundText);
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int verifyMaxFlow(int threads)
+
+    Checks the certificate of the solved graph by threads threads (see
+    graphVerifyFlow) and prints the result. Returns boolean value if the
+    flow and the cut hold.
+   ____________________________________________________________________________
+ */
+int verifyMaxFlow(int threads) {
+    int violations = graphVerifyFlow(graphPointer, threads, stdout);
+
+    if (violations == 0) {
+        printf("Flow verified.\n");
+        return SUCCESS;
+    }
+
+    if (violations > 0) {
+        printf("Flow verification failed, %d violations.\n", violations);
+    } else {
+        printf("Unable to verify flow.\n");
+    }
+    return FAILURE;
+}
+
 /* ____________________________________________________________________________
 
     MAIN PROGRAM
@@ -71,18 +178,65 @@ int main(int argc, char *argv[]) {
     int j;
     int source;
     int target;
+    int sourceCount = 0;
+    int targetCount = 0;
+    int multiple;
     int workWithInvalid = 0;
+    int undirected = 0;
+    char *nodesName;
+    char *edgesName;
+    int order = ORDER_RCM;
+    int regions = 0;
+    int engine = ENGINE_DINIC;
+    char *socketName;
+    char *vitalName = NULL;
+    int top = 0;
+    int threads = VITAL_DEFAULT_THREADS;
+    serverConfig config;
+    mappedStore *store = NULL;
+    int hugePages;
+    char *checkpointName;
+    char *resumeName = NULL;
+    double interval = CHECKPOINT_DEFAULT_INTERVAL;
+    int solved = FAILURE;
+    char *validName;
+    double timeLimit = 0;
+    double gapLimit = 0;
+    int verify;
     /* all possible switches */
-    char *switches[6] = {"-v", "-a", "-e", "-s", "-t", "-out"};
+    char *switches[26] = {"-v", "-a", "-e", "-s", "-t", "-out", "-order", "-partition", "-time", "-gap", "-u",
+                          "-engine", "-serve", "-threads", "-mmap", "-vital", "-top", "-outvalid", "-hugepages",
+                          "-checkpoint", "-interval", "-resume", "-paths", "-flows", "-flowscsv",
+                          "-verify"};
+
+    /* with -verify the certificate of every solve is checked before anything is written */
+    verify = findInInput(argc, argv, switches[25]) != -1;
+
+    /* with -u every edge can carry flow in both directions */
+    undirected = findInInput(argc, argv, switches[10]) != -1;
+    workWithInvalid = findInInput(argc, argv, switches[INVALID_EDGES]) != -1;
 
-    for (j = 0; j < 5; j++) {
+    /* with -outvalid the network of valid edges is solved first, so invalid edges are loaded too */
+    index = findInInput(argc, argv, switches[17]);
+    validName = VALIDATE_INDEX(index, argc) ? argv[index + 1] : NULL;
+    if (validName) workWithInvalid = 1;
+
+    /* node file and edge file are loaded at the same time, the results are checked below */
+    index = findInInput(argc, argv, switches[NODES]);
+    nodesName = VALIDATE_INDEX(index, argc) ? argv[index + 1] : NULL;
+    index = findInInput(argc, argv, switches[EDGES]);
+    edgesName = VALIDATE_INDEX(index, argc) ? argv[index + 1] : NULL;
+    loadFiles(nodesName, edgesName, workWithInvalid, undirected, &loadedNodes, &loadedEdges);
+
+    /* server answers queries for any source and target, so they are not required */
+    index = findInInput(argc, argv, switches[12]);
+    socketName = VALIDATE_INDEX(index, argc) ? argv[index + 1] : NULL;
+
+    for (j = 0; j < (socketName ? SOURCE : 5); j++) {
         index = findInInput(argc, argv, switches[j]);
 
         switch (j) {
             case NODES:
-                if (VALIDATE_INDEX(index, argc)) {
-                    loadedNodes = loadNodes(argv[index + 1]);
-                }
                 if (!loadedNodes) {
                     cleanEverything();
                     printf("Invalid vertex file.\n");
@@ -91,15 +245,9 @@ int main(int argc, char *argv[]) {
                 break;
 
             case INVALID_EDGES:
-                if (index != -1) {
-                    workWithInvalid = 1;
-                }
                 break;
 
             case EDGES:
-                if (VALIDATE_INDEX(index, argc)) {
-                    loadedEdges = loadEdges(argv[index + 1], workWithInvalid, loadedNodes->size);
-                }
                 if (!loadedEdges) {
                     cleanEverything();
                     printf("Invalid edge file.\n");
@@ -108,26 +256,25 @@ int main(int argc, char *argv[]) {
                 break;
 
             case SOURCE:
-                if (VALIDATE_INDEX(index, argc)) {
-                    source = strtol(argv[index + 1], NULL, 10);
-                }
-                if (!hashTableContains(source, loadedNodes)) {
+                /* source and target can be lists of nodes or files with them (see loadTerminals) */
+                sources = VALIDATE_INDEX(index, argc) ? loadTerminals(argv[index + 1], &sourceCount) : NULL;
+                if (!sources || !checkTerminals(sources, sourceCount, NULL, 0)) {
                     cleanEverything();
                     printf("Invalid source vertex.\n");
                     return 3;
                 }
+                source = sources[0].id;
                 break;
 
             case TARGET:
-                if (VALIDATE_INDEX(index, argc)) {
-                    target = strtol(argv[index + 1], NULL, 10);
-                }
-                if ((target == source) || !hashTableContains(target, loadedNodes)) {
+                targets = VALIDATE_INDEX(index, argc) ? loadTerminals(argv[index + 1], &targetCount) : NULL;
+                if (!targets || !checkTerminals(targets, targetCount, sources, sourceCount)) {
 
                     cleanEverything();
                     printf("Invalid sink vertex.\n");
                     return 4;
                 }
+                target = targets[0].id;
                 break;
 
             default:
@@ -135,16 +282,245 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    graphPointer = createNewGraph(loadedNodes, loadedEdges);
+    /* node order decides how the graph is laid out in memory (see order.h) */
+    index = findInInput(argc, argv, switches[6]);
+    if (index != -1) {
+        order = VALIDATE_INDEX(index, argc) ? orderFromName(argv[index + 1]) : -1;
+        if (order == -1) {
+            cleanEverything();
+            printf("Invalid node order.\n");
+            return 8;
+        }
+    }
+
+    /* engine decides how blocking flow of Dinics algorithm is found */
+    index = findInInput(argc, argv, switches[11]);
+    if (index != -1) {
+        engine = VALIDATE_INDEX(index, argc) ? graphEngineFromName(argv[index + 1]) : -1;
+        if (engine == -1) {
+            cleanEverything();
+            printf("Invalid engine.\n");
+            return 11;
+        }
+    }
+
+    /* with -partition the regions of the graph are solved in worker processes */
+    index = findInInput(argc, argv, switches[7]);
+    if (index != -1) {
+        regions = VALIDATE_INDEX(index, argc) ? strtol(argv[index + 1], NULL, 10) : 0;
+        if (regions < 1 || regions > PARTITION_MAX_REGIONS) {
+            cleanEverything();
+            printf("Invalid number of regions.\n");
+            return 9;
+        }
+    }
+
+    /* -time and -gap allow to stop the solve before maximal flow is found */
+    index = findInInput(argc, argv, switches[8]);
+    if (index != -1) {
+        timeLimit = VALIDATE_INDEX(index, argc) ? strtod(argv[index + 1], NULL) : 0;
+        if (timeLimit <= 0) {
+            cleanEverything();
+            printf("Invalid time limit.\n");
+            return 10;
+        }
+    }
+    index = findInInput(argc, argv, switches[9]);
+    if (index != -1) {
+        gapLimit = VALIDATE_INDEX(index, argc) ? strtod(argv[index + 1], NULL) : 0;
+        if (gapLimit <= 0 || gapLimit >= 1) {
+            cleanEverything();
+            printf("Invalid gap limit.\n");
+            return 10;
+        }
+    }
+
+    /* partitioned solve always runs to the exact flow by Dinics algorithm */
+    if (regions && (timeLimit > 0 || gapLimit > 0 || engine != ENGINE_DINIC)) {
+        cleanEverything();
+        printf("-partition can't be combined with -time, -gap or -engine.\n");
+        return 9;
+    }
+
+    /* with -serve the graph is kept loaded and queries come over the socket */
+    if (socketName) {
+        config.socketName = socketName;
+        config.nodesName = nodesName;
+        config.edgesName = edgesName;
+        config.workWithInvalid = workWithInvalid;
+        config.undirected = undirected;
+        config.order = order;
+        config.engine = engine;
+        config.threads = SERVER_DEFAULT_THREADS;
+
+        index = findInInput(argc, argv, switches[13]);
+        if (index != -1) {
+            config.threads = VALIDATE_INDEX(index, argc) ? strtol(argv[index + 1], NULL, 10) : 0;
+            if (config.threads < 1 || config.threads > SERVER_MAX_THREADS) {
+                cleanEverything();
+                printf("Invalid number of threads.\n");
+                return 12;
+            }
+        }
+
+        /* the server takes over loaded tables */
+        j = serverRun(&config, loadedNodes, loadedEdges);
+        loadedNodes = NULL;
+        loadedEdges = NULL;
+        if (!j) {
+            printf("Unable to start server.\n");
+            return 13;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    /* with -vital drop of the flow is found for removal of every edge, -top limits the output */
+    index = findInInput(argc, argv, switches[15]);
+    if (index != -1) {
+        vitalName = VALIDATE_INDEX(index, argc) ? argv[index + 1] : NULL;
+        if (!vitalName) {
+            cleanEverything();
+            printf("Invalid vital file.\n");
+            return 15;
+        }
+    }
+    index = findInInput(argc, argv, switches[16]);
+    if (index != -1) {
+        top = VALIDATE_INDEX(index, argc) ? strtol(argv[index + 1], NULL, 10) : 0;
+        if (!vitalName || top < 1) {
+            cleanEverything();
+            printf("Invalid number of vital edges.\n");
+            return 15;
+        }
+    }
+    index = findInInput(argc, argv, switches[13]);
+    if (index != -1) {
+        threads = VALIDATE_INDEX(index, argc) ? strtol(argv[index + 1], NULL, 10) : 0;
+        if (threads < 1 || threads > VITAL_MAX_THREADS) {
+            cleanEverything();
+            printf("Invalid number of threads.\n");
+            return 12;
+        }
+    }
+
+    /* with -mmap arc arrays of the graph are kept in files of the directory */
+    index = findInInput(argc, argv, switches[14]);
+    if (index != -1) {
+        store = VALIDATE_INDEX(index, argc) ? createMappedStore(argv[index + 1]) : NULL;
+        if (!store) {
+            cleanEverything();
+            printf("Invalid mmap directory.\n");
+            return 14;
+        }
+    }
+
+    /* with -hugepages arrays of the graph are kept in huge pages, they are interleaved
+       over NUMA nodes when several threads evaluate vital edges */
+    hugePages = findInInput(argc, argv, switches[18]) != -1;
+    if (hugePages) {
+        if (store) {
+            freeMappedStore(&store);
+            cleanEverything();
+            printf("Huge pages can't be used with -mmap.\n");
+            return 16;
+        }
+        store = createHugePageStore(vitalName && threads > 1);
+        if (!store) {
+            cleanEverything();
+            printf("Huge pages are not available.\n");
+            return 16;
+        }
+    }
+
+    /* long solves save their flow into the checkpoint, a stopped solve is resumed from it */
+    index = findInInput(argc, argv, switches[19]);
+    checkpointName = VALIDATE_INDEX(index, argc) ? argv[index + 1] : NULL;
+    index = findInInput(argc, argv, switches[20]);
+    if (index != -1) {
+        interval = VALIDATE_INDEX(index, argc) ? strtod(argv[index + 1], NULL) : -1;
+        if (!checkpointName || interval < 0) {
+            freeMappedStore(&store);
+            cleanEverything();
+            printf("Invalid checkpoint interval.\n");
+            return 17;
+        }
+    }
+    index = findInInput(argc, argv, switches[21]);
+    if (index != -1) {
+        resumeName = VALIDATE_INDEX(index, argc) ? argv[index + 1] : NULL;
+        if (!resumeName) {
+            freeMappedStore(&store);
+            cleanEverything();
+            printf("Invalid checkpoint file.\n");
+            return 17;
+        }
+    }
+
+    /* graph is built only over nodes which can lie on some path from source to target,
+       the core nodes take over everything which is needed from loaded nodes */
+    coreNodes = pruneNodes(loadedNodes, loadedEdges, sources, sourceCount, targets, targetCount);
+    freeHashTable(&loadedNodes);
+    if (coreNodes) {
+        graphPointer = createMappedGraph(coreNodes, loadedEdges, order, store);
+    } else {
+        freeMappedStore(&store);
+    }
 
-    if (!graphPointer) {
+    /* several terminals or limits of their flow need virtual super source and super target */
+    multiple = sourceCount > 1 || targetCount > 1 || sources[0].limit > 0 || targets[0].limit > 0;
+    if (!graphPointer || (multiple && !graphAddTerminals(graphPointer, sources, sourceCount, targets, targetCount))) {
         cleanEverything();
         printf("Unable to create graph.\n");
         return 7;
     }
 
-    printf("Max network flow is |x| = %ld.\n", graphMaxFlow(graphPointer, source, target));
-    if (!graphPointer->maxFlow) {
+    /* valid edges are solved first, the flow stays feasible when invalid edges are switched on */
+    if (validName) graphUseInvalid(graphPointer, 0);
+    graphPointer->checkpointName = checkpointName;
+    graphPointer->checkpointInterval = interval;
+    graphPointer->resumeName = resumeName;
+
+    /* if the partitioned solve can't be started, the graph is solved here, resumed solve
+       continues by Dinics algorithm */
+    if (regions && !multiple && !resumeName) {
+        solved = graphPartitionMaxFlow(graphPointer, source, target, regions);
+        if (!solved && graphPointer->flowType != FLOW_REAL) {
+            printf("Partitioned solve failed, the graph is solved without -partition.\n");
+        }
+    }
+    if (!solved && multiple) solved = graphTerminalMaxFlow(graphPointer, engine, timeLimit, gapLimit);
+    if (!solved && !multiple) solved = graphMaxFlow(graphPointer, source, target, engine, timeLimit, gapLimit);
+    if (!solved) {
+        cleanEverything();
+        printf(resumeName ? "Invalid checkpoint file.\n" : "Unable to create graph.\n");
+        return resumeName ? 17 : 7;
+    }
+
+    if (validName) {
+        printMaxFlow("Max network flow over valid edges");
+        if (verify && !verifyMaxFlow(threads)) {
+            cleanEverything();
+            return 20;
+        }
+        if (!writeToOutputFile(validName, graphPointer)) {
+            cleanEverything();
+            printf("Invalid output file.\n");
+            return 5;
+        }
+
+        /* the solve continues from the flow of valid edges, planar engine finds the whole
+           flow at once from its embedding, so it starts again */
+        graphUseInvalid(graphPointer, 1);
+        if (engine == ENGINE_PLANAR) graphResetResidual(graphPointer);
+        graphSolve(graphPointer);
+    }
+
+    printMaxFlow("Max network flow");
+    if (verify && !verifyMaxFlow(threads)) {
+        cleanEverything();
+        return 20;
+    }
+    if (!graphHasFlow(graphPointer)) {
         cleanEverything();
         return 6;
     }
@@ -160,6 +536,42 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    /* routes of the flow, any flow which was found can be decomposed */
+    index = findInInput(argc, argv, switches[22]);
+    if (index != -1) {
+        if (!VALIDATE_INDEX(index, argc) || !graphWritePaths(graphPointer, argv[index + 1])) {
+            cleanEverything();
+            printf("Invalid paths file.\n");
+            return 18;
+        }
+    }
+
+    /* flow of every loaded edge, -flowscsv writes the same as text for debugging */
+    for (j = 23; j <= 24; j++) {
+        index = findInInput(argc, argv, switches[j]);
+        if (index == -1) continue;
+        if (!VALIDATE_INDEX(index, argc) || !writeFlowFile(argv[index + 1], graphPointer, loadedEdges, j == 24)) {
+            cleanEverything();
+            printf("Invalid flows file.\n");
+            return 19;
+        }
+    }
+
+    /* drops are found from the maximal flow, so the flow must be exact */
+    if (vitalName) {
+        if (!graphIsExact(graphPointer)) {
+            cleanEverything();
+            printf("Vital edges need exact flow.\n");
+            return 15;
+        }
+        if (!graphVitalEdges(graphPointer, vitalName, top, threads)) {
+            cleanEverything();
+            printf("Invalid vital file.\n");
+            return 15;
+        }
+    }
+
+    if (hugePages) mappedStoreReport(graphPointer->store, stdout);
 
     cleanEverything();
     return EXIT_SUCCESS;
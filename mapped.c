@@ -0,0 +1,461 @@
+/* ____________________________________________________________________________
+
+    Module mapped.c
+    This module keeps big arrays in memory mapped files, so a graph which
+    doesn't fit into memory can still be solved, the kernel reads and
+    writes pages of the arrays as they are used. Every array is mapped from
+    its own temporary file in the directory of the store, the file is
+    unlinked right away, so it disappears when the array is unmapped or
+    when the programme ends. Access hints are passed to the kernel by
+    posix_madvise. Without store the arrays are allocated in ordinary
+    memory, and so they are on platforms without mmap.
+    Huge page store (Linux only) has no directory, it maps anonymous
+    memory aligned to huge pages, so a big graph needs far fewer TLB
+    entries. Explicit huge pages are used when the administrator reserved
+    enough of them, transparent huge pages are asked for otherwise. The
+    pages can be interleaved over NUMA nodes, the policy is set by mbind
+    before the pages are touched. Placement which was actually achieved is
+    read back from /proc (see mappedStoreReport).
+   ____________________________________________________________________________
+*/
+#ifdef __unix__
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mapped.h"
+
+#define MAPPED_TEMPLATE "/flow-XXXXXX"
+#define MAPPED_NODE_FILE "/sys/devices/system/node/online"
+#define MAPPED_SMAPS_FILE "/proc/self/smaps"
+#define MAPPED_NUMA_FILE "/proc/self/numa_maps"
+#define MAPPED_LINE_SIZE 512
+#define MAPPED_INTERLEAVE 3
+#define MAPPED_MEGABYTE (1024.0 * 1024.0)
+
+/* ____________________________________________________________________________
+
+    mappedStore *createMappedStore(char *directory)
+
+    Creates store which maps arrays from files in the directory. Returns
+    pointer to the store or NULL if the directory isn't writable or if
+    error occurred.
+   ____________________________________________________________________________
+*/
+mappedStore *createMappedStore(char *directory) {
+    mappedStore *store;
+
+    if (!directory) return NULL;
+#ifdef __unix__
+    if (access(directory, W_OK) == -1) return NULL;
+#endif
+
+    store = calloc(1, sizeof(mappedStore));
+    if (!store) return NULL;
+
+    store->directory = malloc(strlen(directory) + 1);
+    if (!store->directory) {
+        free(store);
+        return NULL;
+    }
+    strcpy(store->directory, directory);
+
+    return store;
+}
+
+#ifdef __linux__
+
+/* ____________________________________________________________________________
+
+    int mappedOnlineNodes(unsigned long *mask)
+
+    Reads the list of online NUMA nodes ("0-1" or "0,2-3") into the mask.
+    Returns number of the nodes, 0 if the list can't be read.
+   ____________________________________________________________________________
+*/
+static int mappedOnlineNodes(unsigned long *mask) {
+    int first;
+    int last;
+    int count = 0;
+    int separator;
+    FILE *file = fopen(MAPPED_NODE_FILE, "r");
+
+    *mask = 0;
+    if (!file) return 0;
+
+    while (fscanf(file, "%d", &first) == 1) {
+        last = first;
+        separator = fgetc(file);
+        if (separator == '-') {
+            if (fscanf(file, "%d", &last) != 1) break;
+            separator = fgetc(file);
+        }
+        for (; first <= last && first < MAPPED_MAX_NODES; first++) {
+            *mask |= 1UL << first;
+            count++;
+        }
+        if (separator != ',') break;
+    }
+
+    fclose(file);
+    return count;
+}
+
+#endif
+
+/* ____________________________________________________________________________
+
+    mappedStore *createHugePageStore(int interleave)
+
+    Creates store which keeps arrays in anonymous memory backed by huge
+    pages. If interleave is set and the machine has more NUMA nodes, pages
+    of every array are spread over all of them, otherwise every page lands
+    on the node of the thread which touches it first. Returns pointer to
+    the store or NULL if huge pages aren't supported or if error occurred.
+   ____________________________________________________________________________
+*/
+mappedStore *createHugePageStore(int interleave) {
+#ifdef __linux__
+    unsigned long mask;
+    mappedStore *store = calloc(1, sizeof(mappedStore));
+
+    if (!store) return NULL;
+
+    store->nodeCount = mappedOnlineNodes(&mask);
+    if (interleave && store->nodeCount > 1) store->nodeMask = mask;
+
+    return store;
+#else
+    return NULL;
+#endif
+}
+
+#ifdef __unix__
+
+/* ____________________________________________________________________________
+
+    int mappedStoreFind(mappedStore *store, void *memory)
+
+    Returns index of the region of the store which starts at memory or -1
+    if there is no such region.
+   ____________________________________________________________________________
+*/
+static int mappedStoreFind(mappedStore *store, void *memory) {
+    int i;
+
+    for (i = 0; i < store->count; i++) {
+        if (store->memory[i] == memory) return i;
+    }
+
+    return -1;
+}
+
+/* ____________________________________________________________________________
+
+    void *mappedHugeAlloc(mappedStore *store, size_t *size)
+
+    Maps anonymous array of at least size bytes aligned to huge pages,
+    size is rounded up to whole huge pages. Returns pointer to the array
+    or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+static void *mappedHugeAlloc(mappedStore *store, size_t *size) {
+#ifdef __linux__
+    char *memory = MAP_FAILED;
+    size_t extra;
+    size_t length = (*size + MAPPED_HUGE_SIZE - 1) / MAPPED_HUGE_SIZE * MAPPED_HUGE_SIZE;
+    unsigned long mask[2];
+
+#ifdef MAP_HUGETLB
+    /* explicit huge pages exist only if they were reserved, the mapping fails otherwise */
+    memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (memory == MAP_FAILED) {
+        /* transparent huge pages need the array aligned, so one huge page more is mapped and trimmed */
+        memory = mmap(NULL, length + MAPPED_HUGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) return NULL;
+
+        extra = (MAPPED_HUGE_SIZE - (unsigned long) memory % MAPPED_HUGE_SIZE) % MAPPED_HUGE_SIZE;
+        if (extra) munmap(memory, extra);
+        munmap(memory + extra + length, MAPPED_HUGE_SIZE - extra);
+        memory += extra;
+#ifdef MADV_HUGEPAGE
+        madvise(memory, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    /* pages are placed when they are touched first, so the policy must come before;
+       if the kernel refuses it, the pages stay on the first touching node */
+    if (store->nodeMask) {
+        mask[0] = store->nodeMask;
+        mask[1] = 0;
+        syscall(SYS_mbind, memory, length, MAPPED_INTERLEAVE, mask, 8 * sizeof(unsigned long) + 1, 0);
+    }
+
+    *size = length;
+    return memory;
+#else
+    return NULL;
+#endif
+}
+
+#endif
+
+/* ____________________________________________________________________________
+
+    void *mappedStoreAlloc(mappedStore *store, size_t size)
+
+    Allocates array of size bytes filled with zeros, the array is mapped
+    from a new file of the store, huge page store maps it in huge pages,
+    or it's allocated in memory if store is NULL. Returns pointer to the
+    array or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+void *mappedStoreAlloc(mappedStore *store, size_t size) {
+#ifdef __unix__
+    int descriptor;
+    char *name;
+    void *memory;
+
+    if (!store) return calloc(1, size);
+    if (store->count == MAPPED_MAX_REGIONS || size == 0) return NULL;
+
+    if (!store->directory) {
+        memory = mappedHugeAlloc(store, &size);
+        if (!memory) return NULL;
+
+        store->memory[store->count] = memory;
+        store->sizes[store->count] = size;
+        store->count++;
+        return memory;
+    }
+
+    name = malloc(strlen(store->directory) + sizeof(MAPPED_TEMPLATE));
+    if (!name) return NULL;
+    sprintf(name, "%s%s", store->directory, MAPPED_TEMPLATE);
+
+    descriptor = mkstemp(name);
+    if (descriptor == -1) {
+        free(name);
+        return NULL;
+    }
+    unlink(name);
+    free(name);
+
+    /* the file grows without writing, its pages read as zeros */
+    if (ftruncate(descriptor, (off_t) size) == -1) {
+        close(descriptor);
+        return NULL;
+    }
+
+    memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (memory == MAP_FAILED) return NULL;
+
+    store->memory[store->count] = memory;
+    store->sizes[store->count] = size;
+    store->count++;
+    return memory;
+#else
+    return calloc(1, size);
+#endif
+}
+
+/* ____________________________________________________________________________
+
+    void mappedStoreAdvise(mappedStore *store, void *memory, int advice)
+
+    Tells the kernel how the mapped array will be accessed, advice is one
+    of MAPPED_NORMAL, MAPPED_SEQUENTIAL, MAPPED_RANDOM and
+    MAPPED_WILL_NEED. Arrays in ordinary memory are ignored.
+   ____________________________________________________________________________
+*/
+void mappedStoreAdvise(mappedStore *store, void *memory, int advice) {
+#ifdef __unix__
+    int region;
+    int hints[4];
+
+    if (!store || !memory) return;
+
+    region = mappedStoreFind(store, memory);
+    if (region == -1 || advice < MAPPED_NORMAL || advice > MAPPED_WILL_NEED) return;
+
+    hints[MAPPED_NORMAL] = POSIX_MADV_NORMAL;
+    hints[MAPPED_SEQUENTIAL] = POSIX_MADV_SEQUENTIAL;
+    hints[MAPPED_RANDOM] = POSIX_MADV_RANDOM;
+    hints[MAPPED_WILL_NEED] = POSIX_MADV_WILLNEED;
+    posix_madvise(memory, store->sizes[region], hints[advice]);
+#endif
+}
+
+/* ____________________________________________________________________________
+
+    void mappedStoreFree(mappedStore *store, void *memory)
+
+    Releases array allocated by mappedStoreAlloc, mapped array is unmapped
+    and its file disappears.
+   ____________________________________________________________________________
+*/
+void mappedStoreFree(mappedStore *store, void *memory) {
+#ifdef __unix__
+    int region;
+
+    if (!memory) return;
+    if (!store) {
+        free(memory);
+        return;
+    }
+
+    region = mappedStoreFind(store, memory);
+    if (region == -1) return;
+
+    munmap(memory, store->sizes[region]);
+    store->count--;
+    store->memory[region] = store->memory[store->count];
+    store->sizes[region] = store->sizes[store->count];
+#else
+    free(memory);
+#endif
+}
+
+#ifdef __linux__
+
+/* ____________________________________________________________________________
+
+    int mappedStoreOverlaps(mappedStore *store, unsigned long start,
+                            unsigned long end)
+
+    Returns boolean value if some array of the store lies in the memory
+    between start and end.
+   ____________________________________________________________________________
+*/
+static int mappedStoreOverlaps(mappedStore *store, unsigned long start, unsigned long end) {
+    int i;
+    unsigned long memory;
+
+    for (i = 0; i < store->count; i++) {
+        memory = (unsigned long) store->memory[i];
+        if (memory < end && memory + store->sizes[i] > start) return 1;
+    }
+
+    return 0;
+}
+
+#endif
+
+/* ____________________________________________________________________________
+
+    void mappedStoreReport(mappedStore *store, FILE *file)
+
+    Writes placement of the arrays of the store into the file: how much
+    of them is resident, how much lies in huge pages and how much on every
+    NUMA node. The numbers are read from /proc (Linux only), so they show
+    what the kernel actually did, not what was asked for.
+   ____________________________________________________________________________
+*/
+void mappedStoreReport(mappedStore *store, FILE *file) {
+#ifdef __linux__
+    int i;
+    int node;
+    int areaCount = 0;
+    int inside = 0;
+    int lineStart = 1;
+    unsigned long start;
+    unsigned long end;
+    unsigned long areas[MAPPED_MAX_REGIONS];
+    double kilobytes;
+    double pages;
+    double pageSize;
+    double size = 0;
+    double resident = 0;
+    double huge = 0;
+    double linePages[MAPPED_MAX_NODES];
+    double nodeBytes[MAPPED_MAX_NODES];
+    char line[MAPPED_LINE_SIZE];
+    char *token;
+    char *rest;
+    FILE *maps;
+
+    if (!store || !file) return;
+
+    for (i = 0; i < store->count; i++) size += store->sizes[i];
+    for (node = 0; node < MAPPED_MAX_NODES; node++) nodeBytes[node] = 0;
+
+    /* areas of the arrays can merge together, so whole areas are counted */
+    maps = fopen(MAPPED_SMAPS_FILE, "r");
+    while (maps && fgets(line, MAPPED_LINE_SIZE, maps)) {
+        if (lineStart && sscanf(line, "%lx-%lx", &start, &end) == 2) {
+            inside = mappedStoreOverlaps(store, start, end);
+            if (inside && areaCount < MAPPED_MAX_REGIONS) areas[areaCount++] = start;
+        } else if (lineStart && inside) {
+            if (sscanf(line, "Rss: %lf", &kilobytes) == 1) resident += kilobytes * 1024;
+            if (sscanf(line, "AnonHugePages: %lf", &kilobytes) == 1) huge += kilobytes * 1024;
+            if (sscanf(line, "Private_Hugetlb: %lf", &kilobytes) == 1
+                || sscanf(line, "Shared_Hugetlb: %lf", &kilobytes) == 1) {
+                huge += kilobytes * 1024;
+                resident += kilobytes * 1024;
+            }
+        }
+        lineStart = strchr(line, '\n') != NULL;
+    }
+    if (maps) fclose(maps);
+
+    /* every area has one line, "N1=20" says that 20 of its pages are on node 1 */
+    lineStart = 1;
+    maps = fopen(MAPPED_NUMA_FILE, "r");
+    while (maps && fgets(line, MAPPED_LINE_SIZE, maps)) {
+        inside = 0;
+        if (lineStart && sscanf(line, "%lx", &start) == 1) {
+            for (i = 0; i < areaCount; i++) {
+                if (areas[i] == start) inside = 1;
+            }
+        }
+        lineStart = strchr(line, '\n') != NULL;
+        if (!inside) continue;
+
+        pageSize = 4;
+        for (node = 0; node < MAPPED_MAX_NODES; node++) linePages[node] = 0;
+        /* strtok_r keeps no global state, the library may be used by threads of the host programme */
+        for (token = strtok_r(line, " \n", &rest); token; token = strtok_r(NULL, " \n", &rest)) {
+            if (sscanf(token, "N%d=%lf", &node, &pages) == 2 && node >= 0 && node < MAPPED_MAX_NODES) {
+                linePages[node] += pages;
+            }
+            sscanf(token, "kernelpagesize_kB=%lf", &pageSize);
+        }
+        for (node = 0; node < MAPPED_MAX_NODES; node++) nodeBytes[node] += linePages[node] * pageSize * 1024;
+    }
+    if (maps) fclose(maps);
+
+    fprintf(file, "Arrays: %d, %.1f MB, resident %.1f MB, in huge pages %.1f MB\n", store->count,
+            size / MAPPED_MEGABYTE, resident / MAPPED_MEGABYTE, huge / MAPPED_MEGABYTE);
+    fprintf(file, "NUMA nodes: %d, pages %s\n", store->nodeCount,
+            store->nodeMask ? "interleaved" : "placed by first touch");
+    for (node = 0; node < MAPPED_MAX_NODES; node++) {
+        if (nodeBytes[node] > 0) fprintf(file, "Node %d: %.1f MB\n", node, nodeBytes[node] / MAPPED_MEGABYTE);
+    }
+#endif
+}
+
+/* ____________________________________________________________________________
+
+    void freeMappedStore(mappedStore **store)
+
+    Unmaps all remaining arrays of the store and frees the store.
+   ____________________________________________________________________________
+*/
+void freeMappedStore(mappedStore **store) {
+    if (!store || !*store) return;
+
+    while ((*store)->count > 0) mappedStoreFree(*store, (*store)->memory[0]);
+    free((*store)->directory);
+    free(*store);
+    *store = NULL;
+}
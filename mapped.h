@@ -0,0 +1,47 @@
+#ifndef SEMESTRALKA_MAPPED_H
+#define SEMESTRALKA_MAPPED_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define MAPPED_MAX_REGIONS 32
+#define MAPPED_MAX_NODES 32
+#define MAPPED_HUGE_SIZE (2UL * 1024 * 1024)
+#define MAPPED_NORMAL 0
+#define MAPPED_SEQUENTIAL 1
+#define MAPPED_RANDOM 2
+#define MAPPED_WILL_NEED 3
+
+/* store keeps arrays in files only with directory, huge page store keeps them in memory */
+#define MAPPED_FROM_FILES(store) ((store) && (store)->directory)
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct {
+    char *directory;
+    unsigned long nodeMask;
+    int nodeCount;
+    int count;
+    void *memory[MAPPED_MAX_REGIONS];
+    size_t sizes[MAPPED_MAX_REGIONS];
+} mappedStore;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+mappedStore *createMappedStore(char *directory);
+mappedStore *createHugePageStore(int interleave);
+void *mappedStoreAlloc(mappedStore *store, size_t size);
+void mappedStoreAdvise(mappedStore *store, void *memory, int advice);
+void mappedStoreFree(mappedStore *store, void *memory);
+void mappedStoreReport(mappedStore *store, FILE *file);
+void freeMappedStore(mappedStore **store);
+
+#endif
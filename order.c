@@ -0,0 +1,352 @@
+/* ____________________________________________________________________________
+
+    Module order.c
+    This module contains functions which find the order in which nodes of the
+    graph are stored. Nodes which are close to each other in the graph (or
+    on the map) get close indices, so the algorithm doesn't jump randomly
+    through the memory. Breadth first order, reverse Cuthill-McKee order and
+    order along Hilbert curve over node coordinates are supported.
+   ____________________________________________________________________________
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "order.h"
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/* qsort doesn't allow to pass any context to the compare function, so the
+   sort key travels with the node, no shared state is needed */
+typedef struct {
+    unsigned long key;
+    int node;
+} orderKey;
+
+/* ____________________________________________________________________________
+
+    int orderFromName(char *name)
+
+    Returns order method described by name ("none", "bfs", "rcm" or
+    "hilbert") or -1 if the name is unknown.
+   ____________________________________________________________________________
+*/
+int orderFromName(char *name) {
+    if (!name) return -1;
+
+    if (strcmp(name, "none") == 0) return ORDER_NONE;
+    if (strcmp(name, "bfs") == 0) return ORDER_BFS;
+    if (strcmp(name, "rcm") == 0) return ORDER_RCM;
+    if (strcmp(name, "hilbert") == 0) return ORDER_HILBERT;
+
+    return -1;
+}
+
+/* ____________________________________________________________________________
+
+    int compareByKey(const void *a, const void *b)
+
+    Auxiliary function which compares two orderKeys by their key (degree
+    or Hilbert key), ties are broken by node index. Necessary for using
+    qsort.
+   ____________________________________________________________________________
+*/
+static int compareByKey(const void *a, const void *b) {
+    const orderKey *first = a;
+    const orderKey *second = b;
+
+    if (first->key != second->key) return first->key < second->key ? -1 : 1;
+    return first->node - second->node;
+}
+
+/* ____________________________________________________________________________
+
+    int orderBfs(int start, int *first, int *neighbours, int *order,
+                 int filled, char *visited, orderKey *keys)
+
+    Appends all nodes reachable from start node to the order array in
+    breadth first order (the array itself is used as a queue). If keys
+    array is given (place for all nodes), neighbours of every node are
+    appended from the one with the lowest degree (Cuthill-McKee). Returns
+    new number of items in the order array.
+   ____________________________________________________________________________
+*/
+static int orderBfs(int start, int *first, int *neighbours, int *order, int filled, char *visited,
+                    orderKey *keys) {
+    int i;
+    int head = filled;
+    int node;
+    int added;
+
+    visited[start] = 1;
+    order[filled++] = start;
+
+    while (head < filled) {
+        node = order[head++];
+        added = filled;
+
+        for (i = first[node]; i < first[node + 1]; i++) {
+            if (!visited[neighbours[i]]) {
+                visited[neighbours[i]] = 1;
+                order[filled++] = neighbours[i];
+            }
+        }
+
+        if (keys && filled - added > 1) {
+            for (i = added; i < filled; i++) {
+                keys[i - added].key = (unsigned long) (first[order[i] + 1] - first[order[i]]);
+                keys[i - added].node = order[i];
+            }
+            qsort(keys, filled - added, sizeof(orderKey), compareByKey);
+            for (i = added; i < filled; i++) order[i] = keys[i - added].node;
+        }
+    }
+
+    return filled;
+}
+
+/* ____________________________________________________________________________
+
+    int orderPeripheralNode(int start, int *first, int *neighbours,
+                            int *buffer, char *visited)
+
+    Finds node with the lowest degree in the last bfs level from start node,
+    which is good starting node for Cuthill-McKee ordering. Buffer must have
+    place for the whole component, visited flags are restored.
+   ____________________________________________________________________________
+*/
+static int orderPeripheralNode(int start, int *first, int *neighbours, int *buffer, char *visited) {
+    int i;
+    int head = 0;
+    int filled = 0;
+    int levelStart = 0;
+    int levelEnd;
+    int best;
+    int node;
+
+    visited[start] = 1;
+    buffer[filled++] = start;
+
+    /* bfs level by level, levelStart remembers where the last level begins */
+    while (head < filled) {
+        levelStart = head;
+        levelEnd = filled;
+        for (; head < levelEnd; head++) {
+            node = buffer[head];
+            for (i = first[node]; i < first[node + 1]; i++) {
+                if (!visited[neighbours[i]]) {
+                    visited[neighbours[i]] = 1;
+                    buffer[filled++] = neighbours[i];
+                }
+            }
+        }
+    }
+
+    best = buffer[levelStart];
+    for (i = levelStart; i < filled; i++) {
+        if (first[buffer[i] + 1] - first[buffer[i]] < first[best + 1] - first[best]) best = buffer[i];
+    }
+
+    for (i = 0; i < filled; i++) visited[buffer[i]] = 0;
+
+    return best;
+}
+
+/* ____________________________________________________________________________
+
+    int parsePoint(char *wkt, double *x, double *y)
+
+    Reads coordinates from POINT wkt. Returns boolean value if it was
+    successful.
+   ____________________________________________________________________________
+*/
+int parsePoint(char *wkt, double *x, double *y) {
+    char *bracket;
+
+    if (!wkt || !x || !y || !strstr(wkt, "POINT")) return 0;
+
+    bracket = strchr(wkt, '(');
+    if (!bracket) return 0;
+
+    return sscanf(bracket + 1, "%lf %lf", x, y) == 2;
+}
+
+/* ____________________________________________________________________________
+
+    unsigned long hilbertIndex(unsigned long x, unsigned long y)
+
+    Returns distance of the point [x, y] along Hilbert curve which fills
+    square with side HILBERT_SIDE.
+   ____________________________________________________________________________
+*/
+unsigned long hilbertIndex(unsigned long x, unsigned long y) {
+    unsigned long s;
+    unsigned long rx;
+    unsigned long ry;
+    unsigned long temp;
+    unsigned long d = 0;
+
+    for (s = HILBERT_SIDE / 2; s > 0; s /= 2) {
+        rx = (x & s) > 0;
+        ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+
+        /* rotate the quadrant */
+        if (ry == 0) {
+            if (rx == 1) {
+                x = HILBERT_SIDE - 1 - x;
+                y = HILBERT_SIDE - 1 - y;
+            }
+            temp = x;
+            x = y;
+            y = temp;
+        }
+    }
+
+    return d;
+}
+
+/* ____________________________________________________________________________
+
+    int orderHilbert(int count, graphNode **nodeList, int *order)
+
+    Fills order array with nodes sorted along Hilbert curve over their
+    coordinates. Nodes without POINT wkt are put at the end. Returns boolean
+    value if it was successful.
+   ____________________________________________________________________________
+*/
+static int orderHilbert(int count, graphNode **nodeList, int *order) {
+    int i;
+    int hasPoint = 0;
+    double *xs;
+    double *ys;
+    double minX = 0;
+    double maxX = 0;
+    double minY = 0;
+    double maxY = 0;
+    double scaleX;
+    double scaleY;
+    orderKey *keys;
+
+    xs = malloc((count + 1) * sizeof(double));
+    ys = malloc((count + 1) * sizeof(double));
+    keys = malloc((count + 1) * sizeof(orderKey));
+    if (!xs || !ys || !keys) {
+        free(xs);
+        free(ys);
+        free(keys);
+        return 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        keys[i].node = i;
+        /* nodes without coordinates keep the biggest key */
+        keys[i].key = NO_POINT;
+        if (!parsePoint(nodeList[i]->wkt, &xs[i], &ys[i])) continue;
+
+        if (!hasPoint || xs[i] < minX) minX = xs[i];
+        if (!hasPoint || xs[i] > maxX) maxX = xs[i];
+        if (!hasPoint || ys[i] < minY) minY = ys[i];
+        if (!hasPoint || ys[i] > maxY) maxY = ys[i];
+        keys[i].key = 0;
+        hasPoint = 1;
+    }
+
+    scaleX = maxX > minX ? (HILBERT_SIDE - 1) / (maxX - minX) : 0;
+    scaleY = maxY > minY ? (HILBERT_SIDE - 1) / (maxY - minY) : 0;
+
+    for (i = 0; i < count; i++) {
+        if (keys[i].key == NO_POINT) continue;
+        keys[i].key = hilbertIndex((unsigned long) ((xs[i] - minX) * scaleX),
+                                   (unsigned long) ((ys[i] - minY) * scaleY));
+    }
+
+    qsort(keys, count, sizeof(orderKey), compareByKey);
+    for (i = 0; i < count; i++) order[i] = keys[i].node;
+
+    free(xs);
+    free(ys);
+    free(keys);
+    return 1;
+}
+
+/* ____________________________________________________________________________
+
+    int *orderNodes(int method, int count, int *first, int *neighbours,
+                    graphNode **nodeList)
+
+    Finds new order of count nodes. Neighbours of node i are stored in the
+    neighbours array between indices first[i] and first[i + 1] (both
+    directions of every edge must be present). NodeList is used only by
+    Hilbert order. Returns array where on index k is the old index of the
+    node which should be k-th, or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+int *orderNodes(int method, int count, int *first, int *neighbours, graphNode **nodeList) {
+    int i;
+    int filled = 0;
+    int temp;
+    int *order;
+    int *buffer = NULL;
+    orderKey *keys = NULL;
+    char *visited;
+
+    if (count <= 0 || !first || !neighbours) return NULL;
+
+    order = malloc(count * sizeof(int));
+    visited = calloc(count, sizeof(char));
+    if (!order || !visited) {
+        free(order);
+        free(visited);
+        return NULL;
+    }
+
+    switch (method) {
+        case ORDER_BFS:
+            for (i = 0; i < count; i++) {
+                if (!visited[i]) filled = orderBfs(i, first, neighbours, order, filled, visited, NULL);
+            }
+            break;
+
+        case ORDER_RCM:
+            buffer = malloc(count * sizeof(int));
+            keys = malloc(count * sizeof(orderKey));
+            if (!buffer || !keys) {
+                free(order);
+                order = NULL;
+                break;
+            }
+
+            for (i = 0; i < count; i++) {
+                if (visited[i]) continue;
+                temp = orderPeripheralNode(i, first, neighbours, buffer, visited);
+                filled = orderBfs(temp, first, neighbours, order, filled, visited, keys);
+            }
+
+            /* reverse Cuthill-McKee order */
+            for (i = 0; i < count / 2; i++) {
+                temp = order[i];
+                order[i] = order[count - 1 - i];
+                order[count - 1 - i] = temp;
+            }
+            break;
+
+        case ORDER_HILBERT:
+            if (!nodeList || !orderHilbert(count, nodeList, order)) {
+                free(order);
+                order = NULL;
+            }
+            break;
+
+        default:
+            for (i = 0; i < count; i++) order[i] = i;
+    }
+
+    free(buffer);
+    free(keys);
+    free(visited);
+    return order;
+}
@@ -0,0 +1,24 @@
+#ifndef SEMESTRALKA_ORDER_H
+#define SEMESTRALKA_ORDER_H
+
+#include "structs.h"
+
+#define ORDER_NONE 0
+#define ORDER_BFS 1
+#define ORDER_RCM 2
+#define ORDER_HILBERT 3
+#define HILBERT_SIDE 65536UL
+#define NO_POINT ((unsigned long) -1)
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int orderFromName(char *name);
+int *orderNodes(int method, int count, int *first, int *neighbours, graphNode **nodeList);
+int parsePoint(char *wkt, double *x, double *y);
+unsigned long hilbertIndex(unsigned long x, unsigned long y);
+
+#endif
@@ -0,0 +1,602 @@
+/* ____________________________________________________________________________
+
+    Module partition.c
+    This module contains partitioned version of the maximal flow algorithm.
+    Nodes of the graph are split into regions by their index (which follows
+    the node order, so regions are compact) and every region is discharged
+    by push-relabel algorithm in separate worker process. Residual
+    capacities, excesses and labels live in POSIX shared memory. Flow pushed
+    over the boundary of a region is stored aside and delivered to the other
+    region between sweeps, labels of other regions are frozen during a
+    sweep. The preflow found by the workers is then turned into flow and
+    finished by Dinics algorithm, so the result is always exact.
+   ____________________________________________________________________________
+*/
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#include <fcntl.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "partition.h"
+#include "graph.h"
+
+#define PARTITION_LABEL(x) ((((x) >= first) && ((x) < last)) ? label[x] : shared->frozen[x])
+#define PARTITION_BACK_FLOW(arc) (residual[arc] - capacity[arc])
+
+/* ____________________________________________________________________________
+
+    void graphReturnExcess(graph *graphPointer, long *capacity,
+                           long *residual, long *excess)
+
+    Turns preflow into flow. Excess of every node (other than source and
+    target) is sent back to the source along arcs which carry flow into
+    the node, flow cycles found on the way are cancelled. Capacity and
+    residual arrays are indexed by arc, residual array is updated. Excess
+    array is indexed by node index and it's updated too.
+   ____________________________________________________________________________
+*/
+void graphReturnExcess(graph *graphPointer, long *capacity, long *residual, long *excess) {
+    int i;
+    int k;
+    int node;
+    int top;
+    int arcsEnd;
+    long amount;
+    int *path;
+    int *arcs;
+    int *head;
+    char *onPath;
+    graphNode *nodeList;
+
+    if (!graphPointer || !capacity || !residual || !excess) return;
+    nodeList = graphPointer->nodeList;
+    arcs = graphPointer->arcs;
+    head = graphPointer->head;
+
+    path = malloc((graphPointer->nodeCount + 1) * sizeof(int));
+    onPath = calloc(graphPointer->nodeCount, sizeof(char));
+    if (!path || !onPath) {
+        free(path);
+        free(onPath);
+        return;
+    }
+
+    for (i = 0; i < graphPointer->nodeCount; i++) nodeList[i].next = graphPointer->firstArc[i];
+
+    for (i = 0; i < graphPointer->nodeCount; i++) {
+        if (excess[i] <= 0 || i == graphPointer->source || i == graphPointer->target) continue;
+
+        /* path holds arcs which lead back from node i, every arc is the
+           reverse arc of some arc with positive flow */
+        top = 0;
+        node = i;
+        onPath[i] = 1;
+        while (excess[i] > 0) {
+            if (node == graphPointer->source) {
+                amount = excess[i];
+                for (k = 0; k < top; k++) amount = MIN(amount, PARTITION_BACK_FLOW(path[k]));
+                for (k = 0; k < top; k++) {
+                    residual[path[k]] -= amount;
+                    residual[REVERSE(path[k])] += amount;
+                    onPath[head[path[k]]] = 0;
+                }
+                excess[i] -= amount;
+                excess[graphPointer->source] += amount;
+
+                top = 0;
+                node = i;
+                continue;
+            }
+
+            /* arcs which were already used up are skipped for good, flow
+               on them can't become negative again */
+            arcsEnd = graphPointer->firstArc[node + 1];
+            while (nodeList[node].next < arcsEnd && PARTITION_BACK_FLOW(arcs[nodeList[node].next]) <= 0) {
+                nodeList[node].next++;
+            }
+            /* this should never happen, every node on the path has some incoming flow */
+            if (nodeList[node].next == arcsEnd) break;
+
+            path[top++] = arcs[nodeList[node].next];
+            node = head[path[top - 1]];
+            if (!onPath[node]) {
+                onPath[node] = 1;
+                continue;
+            }
+
+            /* flow cycle was found, it's cancelled and the path is shortened
+               to the node where the cycle begins */
+            for (k = top - 1; head[REVERSE(path[k])] != node; k--);
+            amount = PARTITION_BACK_FLOW(path[k]);
+            for (arcsEnd = k; arcsEnd < top; arcsEnd++) {
+                amount = MIN(amount, PARTITION_BACK_FLOW(path[arcsEnd]));
+            }
+            for (arcsEnd = k; arcsEnd < top; arcsEnd++) {
+                residual[path[arcsEnd]] -= amount;
+                residual[REVERSE(path[arcsEnd])] += amount;
+                if (head[path[arcsEnd]] != node) onPath[head[path[arcsEnd]]] = 0;
+            }
+            top = k;
+        }
+
+        for (k = 0; k < top; k++) onPath[head[path[k]]] = 0;
+        onPath[i] = 0;
+    }
+
+    free(path);
+    free(onPath);
+}
+
+#ifdef __unix__
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct {
+    int regions;
+    int stop;
+    int failed;
+    sem_t done;
+} partitionControl;
+
+typedef struct {
+    partitionControl *control;
+    sem_t *start;
+    long *residual;
+    long *pushed;
+    long *excess;
+    int *label;
+    int *frozen;
+    void *memory;
+    size_t size;
+} partitionShared;
+
+/* ____________________________________________________________________________
+
+    size_t partitionAlign(size_t size)
+
+    Rounds size up to the multiple of PARTITION_ALIGN.
+   ____________________________________________________________________________
+*/
+static size_t partitionAlign(size_t size) {
+    return (size + PARTITION_ALIGN - 1) / PARTITION_ALIGN * PARTITION_ALIGN;
+}
+
+/* ____________________________________________________________________________
+
+    int partitionCreateShared(graph *graphPointer, int regions,
+                              partitionShared *shared)
+
+    Creates shared memory object for the graph and the regions and maps it.
+    The object is unlinked right away, worker processes inherit the mapping.
+    Returns boolean value if it was successful.
+   ____________________________________________________________________________
+*/
+static int partitionCreateShared(graph *graphPointer, int regions, partitionShared *shared) {
+    int i;
+    int descriptor;
+    char name[64];
+    size_t offsets[7];
+    char *memory;
+
+    offsets[0] = partitionAlign(sizeof(partitionControl));
+    offsets[1] = offsets[0] + partitionAlign(regions * sizeof(sem_t));
+    offsets[2] = offsets[1] + partitionAlign(graphPointer->arcCount * sizeof(long));
+    offsets[3] = offsets[2] + partitionAlign(graphPointer->arcCount * sizeof(long));
+    offsets[4] = offsets[3] + partitionAlign(graphPointer->nodeCount * sizeof(long));
+    offsets[5] = offsets[4] + partitionAlign(graphPointer->nodeCount * sizeof(int));
+    offsets[6] = offsets[5] + partitionAlign(graphPointer->nodeCount * sizeof(int));
+
+    sprintf(name, "/flow-partition-%ld", (long) getpid());
+    descriptor = shm_open(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (descriptor == -1) return FAILURE;
+
+    if (ftruncate(descriptor, offsets[6]) == -1) {
+        close(descriptor);
+        shm_unlink(name);
+        return FAILURE;
+    }
+
+    memory = mmap(NULL, offsets[6], PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    shm_unlink(name);
+    if (memory == MAP_FAILED) return FAILURE;
+
+    shared->memory = memory;
+    shared->size = offsets[6];
+    shared->control = (partitionControl *) memory;
+    shared->start = (sem_t *) (memory + offsets[0]);
+    shared->residual = (long *) (memory + offsets[1]);
+    shared->pushed = (long *) (memory + offsets[2]);
+    shared->excess = (long *) (memory + offsets[3]);
+    shared->label = (int *) (memory + offsets[4]);
+    shared->frozen = (int *) (memory + offsets[5]);
+
+    shared->control->regions = regions;
+    shared->control->stop = 0;
+    shared->control->failed = 0;
+    sem_init(&shared->control->done, 1, 0);
+    for (i = 0; i < regions; i++) sem_init(&shared->start[i], 1, 0);
+
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    void partitionFreeShared(partitionShared *shared)
+
+    Destroys semaphores and unmaps shared memory.
+   ____________________________________________________________________________
+*/
+static void partitionFreeShared(partitionShared *shared) {
+    int i;
+
+    sem_destroy(&shared->control->done);
+    for (i = 0; i < shared->control->regions; i++) sem_destroy(&shared->start[i]);
+    munmap(shared->memory, shared->size);
+}
+
+/* ____________________________________________________________________________
+
+    void partitionWait(sem_t *semaphore)
+
+    Waits on the semaphore, waiting is restarted if a signal interrupts it.
+   ____________________________________________________________________________
+*/
+static void partitionWait(sem_t *semaphore) {
+    while (sem_wait(semaphore) == -1 && errno == EINTR);
+}
+
+/* ____________________________________________________________________________
+
+    void partitionDischarge(graph *graphPointer, partitionShared *shared,
+                            int first, int last, intQueue *queue,
+                            char *inQueue)
+
+    Runs push-relabel algorithm over nodes with indices from first to last
+    (excluded) until no node of the region is active. Labels of the other
+    regions are taken from the frozen copy, flow pushed out of the region is
+    only stored in pushed array. Source and target nodes are never active.
+   ____________________________________________________________________________
+*/
+static void partitionDischarge(graph *graphPointer, partitionShared *shared, int first, int last,
+                               intQueue *queue, char *inQueue) {
+    int node;
+    int edge;
+    int arc;
+    int neighbour;
+    int newLabel;
+    int nodeCount = graphPointer->nodeCount;
+    long amount;
+    long *residual = shared->residual;
+    long *excess = shared->excess;
+    int *label = shared->label;
+    int *arcs = graphPointer->arcs;
+    int *head = graphPointer->head;
+    graphNode *nodeList = graphPointer->nodeList;
+
+    for (node = first; node < last; node++) {
+        nodeList[node].next = graphPointer->firstArc[node];
+        inQueue[node - first] = 0;
+        if (excess[node] > 0 && label[node] < nodeCount && node != graphPointer->source
+            && node != graphPointer->target) {
+            inQueue[node - first] = 1;
+            intQueueEnque(queue, node);
+        }
+    }
+
+    while (!intQueueIsEmpty(queue)) {
+        intQueueDeque(&node, queue);
+        inQueue[node - first] = 0;
+
+        while (excess[node] > 0 && label[node] < nodeCount) {
+            edge = nodeList[node].next;
+
+            /* no admissible arc is left, the node is relabeled */
+            if (edge == graphPointer->firstArc[node + 1]) {
+                newLabel = nodeCount;
+                for (edge = graphPointer->firstArc[node]; edge < graphPointer->firstArc[node + 1]; edge++) {
+                    arc = arcs[edge];
+                    if (residual[arc] <= 0) continue;
+                    newLabel = MIN(newLabel, PARTITION_LABEL(head[arc]) + 1);
+                }
+                label[node] = newLabel > label[node] ? newLabel : label[node] + 1;
+                nodeList[node].next = graphPointer->firstArc[node];
+                continue;
+            }
+
+            arc = arcs[edge];
+            neighbour = head[arc];
+            if (residual[arc] <= 0 || label[node] != PARTITION_LABEL(neighbour) + 1) {
+                nodeList[node].next++;
+                continue;
+            }
+
+            amount = MIN(excess[node], residual[arc]);
+            residual[arc] -= amount;
+            excess[node] -= amount;
+
+            if (neighbour >= first && neighbour < last) {
+                residual[REVERSE(arc)] += amount;
+                excess[neighbour] += amount;
+                if (!inQueue[neighbour - first] && neighbour != graphPointer->source
+                    && neighbour != graphPointer->target) {
+                    inQueue[neighbour - first] = 1;
+                    intQueueEnque(queue, neighbour);
+                }
+            } else {
+                shared->pushed[arc] += amount;
+            }
+        }
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void partitionWorker(graph *graphPointer, partitionShared *shared,
+                         int region)
+
+    Main loop of the worker process. Every time the start semaphore of the
+    region is posted, the region is discharged and done semaphore is posted.
+    If the worker can't allocate its queue, it sets failed of the control
+    and only posts done semaphore. Never returns.
+   ____________________________________________________________________________
+*/
+static void partitionWorker(graph *graphPointer, partitionShared *shared, int region) {
+    int first;
+    int last;
+    char *inQueue;
+    intQueue *queue;
+
+    first = (int) ((double) region * graphPointer->nodeCount / shared->control->regions);
+    last = (int) ((double) (region + 1) * graphPointer->nodeCount / shared->control->regions);
+
+    inQueue = malloc(last - first + 1);
+    queue = createIntQueue(INITIAL_SIZE);
+    if (!inQueue || !queue) shared->control->failed = 1;
+
+    while (1) {
+        partitionWait(&shared->start[region]);
+        if (shared->control->stop) break;
+
+        if (inQueue && queue) partitionDischarge(graphPointer, shared, first, last, queue, inQueue);
+        sem_post(&shared->control->done);
+    }
+
+    free(inQueue);
+    intQueueFreeQueue(&queue);
+    _exit(0);
+}
+
+/* ____________________________________________________________________________
+
+    int partitionGlobalRelabel(graph *graphPointer, partitionShared *shared,
+                               intQueue *queue)
+
+    Sets labels of all nodes to their distance to the target in the residual
+    graph (node count if the target is not reachable, source always has node
+    count), copies them to the frozen labels and returns number of active
+    nodes.
+   ____________________________________________________________________________
+*/
+static int partitionGlobalRelabel(graph *graphPointer, partitionShared *shared, intQueue *queue) {
+    int i;
+    int node;
+    int arc;
+    int neighbour;
+    int active = 0;
+    int nodeCount = graphPointer->nodeCount;
+    int *label = shared->label;
+
+    for (i = 0; i < nodeCount; i++) label[i] = nodeCount;
+    label[graphPointer->target] = 0;
+    intQueueEnque(queue, graphPointer->target);
+
+    while (!intQueueIsEmpty(queue)) {
+        intQueueDeque(&node, queue);
+
+        for (i = graphPointer->firstArc[node]; i < graphPointer->firstArc[node + 1]; i++) {
+            arc = graphPointer->arcs[i];
+            neighbour = graphPointer->head[arc];
+            if (label[neighbour] != nodeCount || neighbour == graphPointer->source
+                || shared->residual[REVERSE(arc)] <= 0) continue;
+
+            label[neighbour] = label[node] + 1;
+            intQueueEnque(queue, neighbour);
+        }
+    }
+
+    memcpy(shared->frozen, label, nodeCount * sizeof(int));
+
+    for (i = 0; i < nodeCount; i++) {
+        if (shared->excess[i] > 0 && label[i] < nodeCount && i != graphPointer->source
+            && i != graphPointer->target) active++;
+    }
+
+    return active;
+}
+
+/* ____________________________________________________________________________
+
+    void partitionDeliver(graph *graphPointer, partitionShared *shared)
+
+    Delivers flow which was pushed over the boundaries of regions during the
+    last sweep.
+   ____________________________________________________________________________
+*/
+static void partitionDeliver(graph *graphPointer, partitionShared *shared) {
+    int i;
+
+    for (i = 0; i < graphPointer->arcCount; i++) {
+        if (!shared->pushed[i]) continue;
+
+        shared->residual[REVERSE(i)] += shared->pushed[i];
+        shared->excess[graphPointer->head[i]] += shared->pushed[i];
+        shared->pushed[i] = 0;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void partitionStopWorkers(partitionShared *shared, pid_t *workers,
+                              int count)
+
+    Tells count worker processes to end and waits for them.
+   ____________________________________________________________________________
+*/
+static void partitionStopWorkers(partitionShared *shared, pid_t *workers, int count) {
+    int i;
+
+    shared->control->stop = 1;
+    for (i = 0; i < count; i++) sem_post(&shared->start[i]);
+    for (i = 0; i < count; i++) waitpid(workers[i], NULL, 0);
+}
+
+/* ____________________________________________________________________________
+
+    int graphPartitionMaxFlow(graph *graphPointer, int source, int target,
+                              int regions)
+
+    Finds maximal flow between source and target nodes (ids of the nodes)
+    with the given number of regions, every region is discharged in its own
+    worker process. The flow is stored in maxFlow of the graph. Returns
+    FAILURE if some of the nodes is not in the graph, if the graph has
+    floating capacities, if shared memory or worker processes can't be
+    created or if some worker can't allocate its memory, in that case the
+    graph is not changed.
+   ____________________________________________________________________________
+*/
+int graphPartitionMaxFlow(graph *graphPointer, int source, int target, int regions) {
+    int i;
+    int sweep;
+    int arc;
+    long amount;
+    long *capacity;
+    graphNode *sourceNode;
+    graphNode *targetNode;
+    pid_t workers[PARTITION_MAX_REGIONS];
+    partitionShared shared;
+    intQueue *queue;
+
+    if (!graphPointer || regions < 1 || graphPointer->flowType == FLOW_REAL) return FAILURE;
+
+    sourceNode = hashTableGetElement(source, graphPointer->nodes);
+    targetNode = hashTableGetElement(target, graphPointer->nodes);
+    if (!sourceNode || !targetNode) return FAILURE;
+
+    regions = MIN(MIN(regions, PARTITION_MAX_REGIONS), graphPointer->nodeCount);
+
+    queue = createIntQueue(INITIAL_SIZE);
+    capacity = malloc((graphPointer->arcCount + 1) * sizeof(long));
+    if (!queue || !capacity) {
+        intQueueFreeQueue(&queue);
+        free(capacity);
+        return FAILURE;
+    }
+    if (!partitionCreateShared(graphPointer, regions, &shared)) {
+        intQueueFreeQueue(&queue);
+        free(capacity);
+        return FAILURE;
+    }
+
+    graphPointer->source = sourceNode->index;
+    graphPointer->target = targetNode->index;
+
+    /* the graph has no flow yet, so its residual capacities are the capacities */
+    graphGetResidual(graphPointer, capacity);
+    memcpy(shared.residual, capacity, graphPointer->arcCount * sizeof(long));
+    memset(shared.pushed, 0, graphPointer->arcCount * sizeof(long));
+    for (i = 0; i < graphPointer->nodeCount; i++) shared.excess[i] = 0;
+
+    /* all arcs from the source are saturated at the beginning */
+    for (i = graphPointer->firstArc[graphPointer->source]; i < graphPointer->firstArc[graphPointer->source + 1]; i++) {
+        arc = graphPointer->arcs[i];
+        amount = shared.residual[arc];
+        if (amount <= 0) continue;
+
+        shared.residual[arc] = 0;
+        shared.residual[REVERSE(arc)] += amount;
+        shared.excess[graphPointer->head[arc]] += amount;
+        shared.excess[graphPointer->source] -= amount;
+    }
+
+    /* output buffers must not be copied into the workers */
+    fflush(NULL);
+    for (i = 0; i < regions; i++) {
+        workers[i] = fork();
+        if (workers[i] == 0) partitionWorker(graphPointer, &shared, i);
+        if (workers[i] == -1) {
+            partitionStopWorkers(&shared, workers, i);
+            partitionFreeShared(&shared);
+            intQueueFreeQueue(&queue);
+            free(capacity);
+            graphPointer->source = -1;
+            graphPointer->target = -1;
+            return FAILURE;
+        }
+    }
+
+    for (sweep = 0; sweep < PARTITION_MAX_SWEEPS; sweep++) {
+        if (!partitionGlobalRelabel(graphPointer, &shared, queue)) break;
+
+        for (i = 0; i < regions; i++) sem_post(&shared.start[i]);
+        for (i = 0; i < regions; i++) partitionWait(&shared.control->done);
+
+        /* some region wasn't discharged, the preflow can't be finished */
+        if (shared.control->failed) break;
+        partitionDeliver(graphPointer, &shared);
+    }
+
+    partitionStopWorkers(&shared, workers, regions);
+    if (shared.control->failed) {
+        partitionFreeShared(&shared);
+        intQueueFreeQueue(&queue);
+        free(capacity);
+        graphPointer->source = -1;
+        graphPointer->target = -1;
+        return FAILURE;
+    }
+
+    /* preflow found by the workers is turned into flow, Dinics algorithm
+       then finds the rest of the flow and the minimal cut */
+    graphReturnExcess(graphPointer, capacity, shared.residual, shared.excess);
+    graphSetResidual(graphPointer, shared.residual);
+    graphPointer->maxFlow.integer = shared.excess[graphPointer->target];
+
+    partitionFreeShared(&shared);
+    intQueueFreeQueue(&queue);
+    free(capacity);
+
+    graphSolve(graphPointer);
+    return SUCCESS;
+}
+
+#else
+
+/* ____________________________________________________________________________
+
+    int graphPartitionMaxFlow(graph *graphPointer, int source, int target,
+                              int regions)
+
+    Worker processes and POSIX shared memory are not available on this
+    platform, so FAILURE is always returned.
+   ____________________________________________________________________________
+*/
+int graphPartitionMaxFlow(graph *graphPointer, int source, int target, int regions) {
+    return FAILURE;
+}
+
+#endif
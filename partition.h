@@ -0,0 +1,19 @@
+#ifndef SEMESTRALKA_PARTITION_H
+#define SEMESTRALKA_PARTITION_H
+
+#include "structs.h"
+
+#define PARTITION_MAX_REGIONS 64
+#define PARTITION_MAX_SWEEPS 100
+#define PARTITION_ALIGN 64
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int graphPartitionMaxFlow(graph *graphPointer, int source, int target, int regions);
+void graphReturnExcess(graph *graphPointer, long *capacity, long *residual, long *excess);
+
+#endif
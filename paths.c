@@ -0,0 +1,274 @@
+/* ____________________________________________________________________________
+
+    Module paths.c
+    This module decomposes the flow of the solved graph into paths from
+    source to target, every path with the amount of flow it carries, so
+    the routes of the flow can be read, not just its cut. Flow of every
+    loaded edge (see graphSplitFlow) becomes an item of its tail node.
+    Paths are walked by depth first search where every node keeps its
+    current item, items are never scanned twice once their flow is used
+    up. When the search reaches target, the path is written and the walk
+    continues from the first item which the path emptied; when it
+    returns to a node of the walk, the flow cycle is cancelled the same
+    way. Paths are written while they are found, so their number is only
+    limited by the file.
+   ____________________________________________________________________________
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include "paths.h"
+#include "graph.h"
+
+typedef struct {
+    int *first;
+    int *next;
+    int *head;
+    double *rest;
+    graphEdge **edges;
+} pathsItems;
+
+/* ____________________________________________________________________________
+
+    void freePathsItems(pathsItems *items)
+
+    Deallocates arrays of the items.
+   ____________________________________________________________________________
+*/
+static void freePathsItems(pathsItems *items) {
+    free(items->first);
+    free(items->next);
+    free(items->head);
+    free(items->rest);
+    free(items->edges);
+}
+
+/* ____________________________________________________________________________
+
+    void pathsAddItem(pathsItems *items, int fill, int tail, int head,
+                      double flow, graphEdge *edgePointer)
+
+    Counts the item (fill is 0) or puts it to its place (fill is 1), items
+    without flow are left out.
+   ____________________________________________________________________________
+*/
+static void pathsAddItem(pathsItems *items, int fill, int tail, int head, double flow, graphEdge *edgePointer) {
+    int item;
+
+    if (flow <= FLOW_EPSILON) return;
+
+    if (!fill) {
+        items->first[tail + 1]++;
+        return;
+    }
+
+    item = items->next[tail]++;
+    items->head[item] = head;
+    items->rest[item] = flow;
+    items->edges[item] = edgePointer;
+}
+
+/* ____________________________________________________________________________
+
+    int createPathsItems(graph *graphPointer, pathsItems *items)
+
+    Creates items of all edges which carry flow, items of node i are
+    between first[i] and first[i + 1]. Members carry the flow in the
+    direction of their arc, undirected ones with negative flow in the
+    opposite one. Virtual arcs of the terminals have no members, they get
+    items without edge. Returns SUCCESS or FAILURE if error occurred.
+   ____________________________________________________________________________
+*/
+static int createPathsItems(graph *graphPointer, pathsItems *items) {
+    int i;
+    int k;
+    int fill;
+    int tail;
+    int count;
+    int virtualArcs = graphPointer->arcCount - 2 * graphPointer->terminalCount;
+    graphEdge *edgePointer;
+
+    items->first = calloc(graphPointer->nodeCount + 1, sizeof(int));
+    items->next = malloc((graphPointer->nodeCount + 1) * sizeof(int));
+    if (!items->first || !items->next) return FAILURE;
+
+    /* the first pass counts the items of every node, the second one fills them */
+    for (fill = 0; fill < 2; fill++) {
+        for (i = 0; i < graphPointer->arcCount; i++) {
+            tail = graphPointer->head[REVERSE(i)];
+            if (i >= virtualArcs) {
+                pathsAddItem(items, fill, tail, graphPointer->head[i], graphArcFlow(graphPointer, i), NULL);
+                continue;
+            }
+            for (k = graphPointer->firstMember[i]; k < graphPointer->firstMember[i + 1]; k++) {
+                edgePointer = graphPointer->memberList[k];
+                pathsAddItem(items, fill, tail, graphPointer->head[i], edgePointer->flow, edgePointer);
+                pathsAddItem(items, fill, graphPointer->head[i], tail, -edgePointer->flow, edgePointer);
+            }
+        }
+
+        if (fill) break;
+
+        for (i = 0; i < graphPointer->nodeCount; i++) items->first[i + 1] += items->first[i];
+        for (i = 0; i <= graphPointer->nodeCount; i++) items->next[i] = items->first[i];
+
+        count = items->first[graphPointer->nodeCount] + 1;
+        items->head = malloc(count * sizeof(int));
+        items->rest = malloc(count * sizeof(double));
+        items->edges = malloc(count * sizeof(graphEdge *));
+        if (!items->head || !items->rest || !items->edges) return FAILURE;
+    }
+
+    /* filling moved next to the end of the items of every node, so it starts again */
+    for (i = 0; i <= graphPointer->nodeCount; i++) items->next[i] = items->first[i];
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    double pathsTake(pathsItems *items, int *walk, int from, int to,
+                     double limit)
+
+    Takes the smallest remaining flow of the items of the walk between
+    positions from and to (at most limit) from all of them. Returns the
+    amount which was taken.
+   ____________________________________________________________________________
+*/
+static double pathsTake(pathsItems *items, int *walk, int from, int to, double limit) {
+    int i;
+    double amount = limit;
+
+    for (i = from; i < to; i++) {
+        if (items->rest[walk[i]] < amount) amount = items->rest[walk[i]];
+    }
+    for (i = from; i < to; i++) items->rest[walk[i]] -= amount;
+
+    return amount;
+}
+
+/* ____________________________________________________________________________
+
+    void pathsWrite(graph *graphPointer, pathsItems *items, int *walk,
+                    int *walkNodes, int depth, double amount, FILE *file)
+
+    Writes one path of the walk: its flow, the first and the last loaded
+    node (virtual terminals are skipped) and ids of its edges.
+   ____________________________________________________________________________
+*/
+static void pathsWrite(graph *graphPointer, pathsItems *items, int *walk, int *walkNodes, int depth, double amount,
+                       FILE *file) {
+    int i;
+    int first = 0;
+    int last = depth;
+    char separator = ',';
+
+    if (graphPointer->nodeList[walkNodes[first]].id == -1) first++;
+    if (graphPointer->nodeList[walkNodes[last]].id == -1) last--;
+
+    fprintf(file, "%.15g,%d,%d", amount, graphPointer->nodeList[walkNodes[first]].id,
+            graphPointer->nodeList[walkNodes[last]].id);
+    for (i = 0; i < depth; i++) {
+        if (!items->edges[walk[i]]) continue;
+        fprintf(file, "%c%d", separator, items->edges[walk[i]]->id);
+        separator = ' ';
+    }
+    fprintf(file, "\n");
+}
+
+/* ____________________________________________________________________________
+
+    int graphWritePaths(graph *graphPointer, char *fileName)
+
+    Decomposes the flow of the solved graph into paths from source to
+    target and writes them into the file (flow,source,target,edges), ids
+    of the edges of a path are separated by spaces. Flow cycles are
+    cancelled, they are not part of any path. Returns SUCCESS or FAILURE
+    if error occurred.
+   ____________________________________________________________________________
+*/
+int graphWritePaths(graph *graphPointer, char *fileName) {
+    int i;
+    int node;
+    int item;
+    int depth = 0;
+    int cycle;
+    int *walk;
+    int *walkNodes;
+    int *onWalk;
+    double amount;
+    pathsItems items = {NULL, NULL, NULL, NULL, NULL};
+    FILE *file;
+
+    if (!graphPointer || !fileName || graphPointer->source == -1) return FAILURE;
+
+    graphSplitFlow(graphPointer);
+    walk = malloc((graphPointer->nodeCount + 1) * sizeof(int));
+    walkNodes = malloc((graphPointer->nodeCount + 1) * sizeof(int));
+    onWalk = malloc(graphPointer->nodeCount * sizeof(int));
+    file = fopen(fileName, "w");
+    if (!walk || !walkNodes || !onWalk || !file || !createPathsItems(graphPointer, &items)) {
+        if (file) fclose(file);
+        free(walk);
+        free(walkNodes);
+        free(onWalk);
+        freePathsItems(&items);
+        return FAILURE;
+    }
+
+    setvbuf(file, NULL, _IOFBF, PATHS_BUFFER_SIZE);
+    fprintf(file, PATHS_HEADER);
+
+    /* walk[i] is the item from walkNodes[i] to walkNodes[i + 1], onWalk is position of the node */
+    for (i = 0; i < graphPointer->nodeCount; i++) onWalk[i] = -1;
+    node = graphPointer->source;
+    walkNodes[0] = node;
+    onWalk[node] = 0;
+
+    while (1) {
+        if (node == graphPointer->target) {
+            amount = pathsTake(&items, walk, 0, depth, DBL_MAX);
+            pathsWrite(graphPointer, &items, walk, walkNodes, depth, amount, file);
+            cycle = 0;
+        } else {
+            /* items without flow are skipped for good */
+            while (items.next[node] < items.first[node + 1] && items.rest[items.next[node]] <= FLOW_EPSILON) {
+                items.next[node]++;
+            }
+
+            /* flow which can't go on is left from rounding, the item which brought it is dropped */
+            if (items.next[node] == items.first[node + 1]) {
+                if (depth == 0) break;
+                onWalk[node] = -1;
+                items.rest[walk[--depth]] = 0;
+                node = walkNodes[depth];
+                continue;
+            }
+
+            item = items.next[node];
+            if (onWalk[items.head[item]] == -1) {
+                walk[depth++] = item;
+                node = items.head[item];
+                walkNodes[depth] = node;
+                onWalk[node] = depth;
+                continue;
+            }
+
+            /* the walk returned to its node, so the cycle is cancelled */
+            cycle = onWalk[items.head[item]];
+            amount = pathsTake(&items, walk, cycle, depth, items.rest[item]);
+            items.rest[item] -= amount;
+        }
+
+        /* the walk goes back to the first item which was emptied */
+        i = cycle;
+        while (i < depth && items.rest[walk[i]] > FLOW_EPSILON) i++;
+        while (depth > i) onWalk[walkNodes[depth--]] = -1;
+        node = walkNodes[depth];
+    }
+
+    free(walk);
+    free(walkNodes);
+    free(onWalk);
+    freePathsItems(&items);
+    return fclose(file) == 0 ? SUCCESS : FAILURE;
+}
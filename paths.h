@@ -0,0 +1,17 @@
+#ifndef SEMESTRALKA_PATHS_H
+#define SEMESTRALKA_PATHS_H
+
+#include "structs.h"
+
+#define PATHS_HEADER "flow,source,target,edges\n"
+#define PATHS_BUFFER_SIZE (1 << 20)
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int graphWritePaths(graph *graphPointer, char *fileName);
+
+#endif
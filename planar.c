@@ -0,0 +1,813 @@
+/* ____________________________________________________________________________
+
+    Module planar.c
+    This module contains maximal flow of planar graphs. Every node is put
+    at the coordinates of its POINT wkt and every pair of arcs becomes a
+    straight segment. If no two segments cross (bridges and tunnels of road
+    networks do), faces of the embedding are traced and the minimal cut is
+    the shortest cycle of the dual graph which separates source from
+    target. The dual is cut open along the shortest dual path between faces
+    at the source and at the target, then the cycle is the shortest of the
+    paths between both copies of some face of the cut, they are found by
+    divide and conquer of Reif (every path limits the region of the next
+    ones). The flow is set from potentials of the faces. Capacities must be
+    the same in both directions of every arc, so it works with undirected
+    graphs only. The code which depends on the capacity type is written
+    once in planarVariant.h.
+   ____________________________________________________________________________
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include "graph.h"
+#include "planar.h"
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct {
+    double angle;
+    int arc;
+} planarDart;
+
+/* darts are arcs of the graph, face of the dart is on its left side, the dual cut open along
+   the path has vertex for every face and another one (right copy) for every face of the path,
+   ports of the vertex are its darts in counterclockwise order, path faces have a gap after
+   the last port where the cut goes through */
+typedef struct {
+    graph *graphPointer;
+    char *used;
+    char *inComponent;
+    int componentNodes;
+    int componentPairs;
+    double *x;
+    double *y;
+    int *rotStart;
+    int *rotArcs;
+    int *rotPos;
+    int faceCount;
+    int *faceStart;
+    int *faceDarts;
+    int *faceOf;
+    int *dartPos;
+    int pathLength;
+    int *pathFaces;
+    int *pathIndex;
+    char *isPathDart;
+    int vertexCount;
+    int *portStart;
+    int *portDart;
+    int *portVertex;
+    int *portTwin;
+    int *portLeft;
+    int *portRight;
+    int stamp;
+    int *seen;
+    int *parent;
+    int region;
+    int *regionMark;
+    int *lowMark;
+    int *lowIn;
+    int *lowOut;
+    int *highMark;
+    int *highIn;
+    int *highOut;
+    int *queue;
+} planarEmbedding;
+
+/* ____________________________________________________________________________
+
+    void freePlanarEmbedding(planarEmbedding **embedding)
+
+    Deallocates memory used by embedding.
+   ____________________________________________________________________________
+*/
+static void freePlanarEmbedding(planarEmbedding **embedding) {
+    planarEmbedding *e;
+
+    if (!embedding || !*embedding) return;
+    e = *embedding;
+
+    free(e->used);
+    free(e->inComponent);
+    free(e->x);
+    free(e->y);
+    free(e->rotStart);
+    free(e->rotArcs);
+    free(e->rotPos);
+    free(e->faceStart);
+    free(e->faceDarts);
+    free(e->faceOf);
+    free(e->dartPos);
+    free(e->pathFaces);
+    free(e->pathIndex);
+    free(e->isPathDart);
+    free(e->portStart);
+    free(e->portDart);
+    free(e->portVertex);
+    free(e->portTwin);
+    free(e->portLeft);
+    free(e->portRight);
+    free(e->seen);
+    free(e->parent);
+    free(e->regionMark);
+    free(e->lowMark);
+    free(e->lowIn);
+    free(e->lowOut);
+    free(e->highMark);
+    free(e->highIn);
+    free(e->highOut);
+    free(e->queue);
+    free(e);
+    *embedding = NULL;
+}
+
+/* ____________________________________________________________________________
+
+    int planarComponent(planarEmbedding *embedding)
+
+    Marks nodes which can be reached from the source by used pairs of arcs
+    (used is 1 for pairs with the same positive capacity of both arcs, 2
+    for pairs with different capacities) and counts them and the pairs.
+    Returns boolean value if the target was reached or -1 if the component
+    has some pair with different capacities or if error occurred.
+   ____________________________________________________________________________
+*/
+static int planarComponent(planarEmbedding *embedding) {
+    int i;
+    int j;
+    int node;
+    int arc;
+    int count = 0;
+    int *queue;
+    graph *graphPointer = embedding->graphPointer;
+
+    queue = malloc(graphPointer->nodeCount * sizeof(int));
+    if (!queue) return -1;
+
+    embedding->inComponent[graphPointer->source] = 1;
+    queue[count++] = graphPointer->source;
+    for (i = 0; i < count; i++) {
+        node = queue[i];
+        for (j = graphPointer->firstArc[node]; j < graphPointer->firstArc[node + 1]; j++) {
+            arc = graphPointer->arcs[j];
+            if (!embedding->used[arc >> 1]) continue;
+            if (embedding->used[arc >> 1] == 2) {
+                free(queue);
+                return -1;
+            }
+
+            if (!(arc & 1)) embedding->componentPairs++;
+            if (embedding->inComponent[graphPointer->head[arc]]) continue;
+            embedding->inComponent[graphPointer->head[arc]] = 1;
+            queue[count++] = graphPointer->head[arc];
+        }
+    }
+
+    embedding->componentNodes = count;
+    free(queue);
+    return embedding->inComponent[graphPointer->target];
+}
+
+/* ____________________________________________________________________________
+
+    int compareDartAngle(const void *a, const void *b)
+
+    Auxiliary function which compares angles of two darts. Necessary for
+    using qsort.
+   ____________________________________________________________________________
+*/
+static int compareDartAngle(const void *a, const void *b) {
+    const planarDart *first = a;
+    const planarDart *second = b;
+
+    if (first->angle < second->angle) return -1;
+    return first->angle > second->angle;
+}
+
+/* ____________________________________________________________________________
+
+    int planarRotations(planarEmbedding *embedding)
+
+    Reads coordinates of the nodes of the component and sorts darts of
+    every node counterclockwise. Returns FAILURE if some node has no
+    coordinates, if some arc has zero length or if two arcs of the node go
+    in the same direction (they overlap), or if error occurred.
+   ____________________________________________________________________________
+*/
+static int planarRotations(planarEmbedding *embedding) {
+    int i;
+    int j;
+    int arc;
+    int count = 0;
+    int degree;
+    int maxDegree = 0;
+    planarDart *darts;
+    graph *graphPointer = embedding->graphPointer;
+
+    for (i = 0; i < graphPointer->nodeCount; i++) {
+        if (!embedding->inComponent[i]) continue;
+        if (!parsePoint(graphPointer->nodeList[i].wkt, &embedding->x[i], &embedding->y[i])) return FAILURE;
+        degree = graphPointer->firstArc[i + 1] - graphPointer->firstArc[i];
+        if (degree > maxDegree) maxDegree = degree;
+    }
+
+    darts = malloc((maxDegree + 1) * sizeof(planarDart));
+    if (!darts) return FAILURE;
+
+    for (i = 0; i < graphPointer->nodeCount; i++) {
+        embedding->rotStart[i] = count;
+        if (!embedding->inComponent[i]) continue;
+
+        degree = 0;
+        for (j = graphPointer->firstArc[i]; j < graphPointer->firstArc[i + 1]; j++) {
+            arc = graphPointer->arcs[j];
+            if (!embedding->used[arc >> 1]) continue;
+
+            if (embedding->x[graphPointer->head[arc]] == embedding->x[i]
+                && embedding->y[graphPointer->head[arc]] == embedding->y[i]) {
+                free(darts);
+                return FAILURE;
+            }
+            darts[degree].angle = atan2(embedding->y[graphPointer->head[arc]] - embedding->y[i],
+                                        embedding->x[graphPointer->head[arc]] - embedding->x[i]);
+            darts[degree].arc = arc;
+            degree++;
+        }
+
+        qsort(darts, degree, sizeof(planarDart), compareDartAngle);
+        for (j = 0; j < degree; j++) {
+            if (j > 0 && darts[j].angle == darts[j - 1].angle) {
+                free(darts);
+                return FAILURE;
+            }
+            embedding->rotPos[darts[j].arc] = j;
+            embedding->rotArcs[count++] = darts[j].arc;
+        }
+    }
+    embedding->rotStart[graphPointer->nodeCount] = count;
+
+    free(darts);
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int planarOrientation(planarEmbedding *embedding, int a, int b, int c)
+
+    Returns 1 if nodes a, b, c turn counterclockwise, -1 if they turn
+    clockwise and 0 if they are collinear.
+   ____________________________________________________________________________
+*/
+static int planarOrientation(planarEmbedding *embedding, int a, int b, int c) {
+    double cross = (embedding->x[b] - embedding->x[a]) * (embedding->y[c] - embedding->y[a])
+                   - (embedding->y[b] - embedding->y[a]) * (embedding->x[c] - embedding->x[a]);
+
+    if (cross > 0) return 1;
+    return cross < 0 ? -1 : 0;
+}
+
+/* ____________________________________________________________________________
+
+    int planarOnSegment(planarEmbedding *embedding, int node, int a, int b)
+
+    Returns boolean value if the node, which is collinear with segment from
+    a to b, lies on the segment.
+   ____________________________________________________________________________
+*/
+static int planarOnSegment(planarEmbedding *embedding, int node, int a, int b) {
+    double *x = embedding->x;
+    double *y = embedding->y;
+
+    return x[node] >= MIN(x[a], x[b]) && x[node] <= (x[a] > x[b] ? x[a] : x[b])
+           && y[node] >= MIN(y[a], y[b]) && y[node] <= (y[a] > y[b] ? y[a] : y[b]);
+}
+
+/* ____________________________________________________________________________
+
+    int planarSegmentsMeet(planarEmbedding *embedding, int first,
+                           int second)
+
+    Returns boolean value if segments of two arcs cross or touch anywhere
+    else than at their common node.
+   ____________________________________________________________________________
+*/
+static int planarSegmentsMeet(planarEmbedding *embedding, int first, int second) {
+    int a = embedding->graphPointer->head[REVERSE(first)];
+    int b = embedding->graphPointer->head[first];
+    int c = embedding->graphPointer->head[REVERSE(second)];
+    int d = embedding->graphPointer->head[second];
+    int o1;
+    int o2;
+    int o3;
+    int o4;
+    int shared = -1;
+    int p = -1;
+    int q = -1;
+
+    if (a == c || a == d) shared = a;
+    if (b == c || b == d) shared = b;
+    if (shared != -1) {
+        /* segments with common node meet elsewhere only if they overlap */
+        p = shared == a ? b : a;
+        q = shared == c ? d : c;
+        return planarOrientation(embedding, shared, p, q) == 0
+               && (embedding->x[p] - embedding->x[shared]) * (embedding->x[q] - embedding->x[shared])
+                  + (embedding->y[p] - embedding->y[shared]) * (embedding->y[q] - embedding->y[shared]) > 0;
+    }
+
+    o1 = planarOrientation(embedding, a, b, c);
+    o2 = planarOrientation(embedding, a, b, d);
+    o3 = planarOrientation(embedding, c, d, a);
+    o4 = planarOrientation(embedding, c, d, b);
+
+    if (o1 * o2 < 0 && o3 * o4 < 0) return 1;
+    return (o1 == 0 && planarOnSegment(embedding, c, a, b)) || (o2 == 0 && planarOnSegment(embedding, d, a, b))
+           || (o3 == 0 && planarOnSegment(embedding, a, c, d)) || (o4 == 0 && planarOnSegment(embedding, b, c, d));
+}
+
+/* ____________________________________________________________________________
+
+    int planarCheckCrossings(planarEmbedding *embedding)
+
+    Checks that no two segments of the component meet outside their common
+    nodes. Segments are put into the cells of a grid over the bounding box
+    (every segment into all cells of its own bounding box) and segments of
+    every cell are tested against each other. Returns FAILURE if some
+    segments meet, if the grid would be too big or too crowded to be
+    checked in reasonable time, or if error occurred.
+   ____________________________________________________________________________
+*/
+static int planarCheckCrossings(planarEmbedding *embedding) {
+    int i;
+    int j;
+    int pass;
+    int cell;
+    int side;
+    int cx;
+    int cy;
+    int a;
+    int b;
+    int range[4];
+    int result = SUCCESS;
+    long entries = 0;
+    long tests = 0;
+    double minX = DBL_MAX;
+    double minY = DBL_MAX;
+    double maxX = -DBL_MAX;
+    double maxY = -DBL_MAX;
+    double width;
+    double height;
+    double *x = embedding->x;
+    double *y = embedding->y;
+    int *cellStart;
+    int *cellFill;
+    int *cellArcs = NULL;
+    graph *graphPointer = embedding->graphPointer;
+
+    for (i = 0; i < graphPointer->nodeCount; i++) {
+        if (!embedding->inComponent[i]) continue;
+        if (x[i] < minX) minX = x[i];
+        if (x[i] > maxX) maxX = x[i];
+        if (y[i] < minY) minY = y[i];
+        if (y[i] > maxY) maxY = y[i];
+    }
+
+    side = (int) sqrt((double) embedding->componentPairs) + 1;
+    width = maxX > minX ? (maxX - minX) / side : 1;
+    height = maxY > minY ? (maxY - minY) / side : 1;
+
+    cellStart = calloc((size_t) side * side + 1, sizeof(int));
+    cellFill = malloc(((size_t) side * side + 1) * sizeof(int));
+    if (!cellStart || !cellFill) result = FAILURE;
+
+    /* the first pass counts segments of the cells, the second one fills them */
+    for (pass = 0; pass < 2 && result; pass++) {
+        for (i = 0; i < graphPointer->arcCount && result; i += 2) {
+            if (!embedding->used[i >> 1] || !embedding->inComponent[graphPointer->head[i]]) continue;
+
+            a = graphPointer->head[i];
+            b = graphPointer->head[i + 1];
+            range[0] = MIN((int) ((MIN(x[a], x[b]) - minX) / width), side - 1);
+            range[1] = MIN((int) ((MIN(y[a], y[b]) - minY) / height), side - 1);
+            range[2] = MIN((int) (((x[a] > x[b] ? x[a] : x[b]) - minX) / width), side - 1);
+            range[3] = MIN((int) (((y[a] > y[b] ? y[a] : y[b]) - minY) / height), side - 1);
+
+            if (pass == 0) {
+                entries += (long) (range[2] - range[0] + 1) * (range[3] - range[1] + 1);
+                if (entries > (long) PLANAR_CELL_LIMIT * embedding->componentPairs + side) result = FAILURE;
+            }
+            for (cx = range[0]; cx <= range[2] && result; cx++) {
+                for (cy = range[1]; cy <= range[3]; cy++) {
+                    cell = cy * side + cx;
+                    if (pass == 0) {
+                        cellStart[cell + 1]++;
+                    } else {
+                        cellArcs[cellFill[cell]++] = i;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0 && result) {
+            for (cell = 0; cell < side * side; cell++) cellStart[cell + 1] += cellStart[cell];
+            memcpy(cellFill, cellStart, (size_t) side * side * sizeof(int));
+            cellArcs = malloc((entries + 1) * sizeof(int));
+            if (!cellArcs) result = FAILURE;
+        }
+    }
+
+    for (cell = 0; cell < side * side && result; cell++) {
+        for (i = cellStart[cell]; i < cellStart[cell + 1] && result; i++) {
+            for (j = i + 1; j < cellStart[cell + 1] && result; j++) {
+                if (++tests > (long) PLANAR_TEST_LIMIT * embedding->componentPairs
+                    || planarSegmentsMeet(embedding, cellArcs[i], cellArcs[j])) result = FAILURE;
+            }
+        }
+    }
+
+    free(cellArcs);
+    free(cellFill);
+    free(cellStart);
+    return result;
+}
+
+/* ____________________________________________________________________________
+
+    int planarFaces(planarEmbedding *embedding)
+
+    Traces faces of the embedding, the next dart of the face is the dart
+    which precedes the reverse dart in the rotation of its head, so the
+    face is on the left side of its darts. Returns FAILURE if Euler's
+    formula doesn't hold (the embedding isn't planar).
+   ____________________________________________________________________________
+*/
+static int planarFaces(planarEmbedding *embedding) {
+    int i;
+    int arc;
+    int node;
+    int degree;
+    int count = 0;
+    graph *graphPointer = embedding->graphPointer;
+
+    for (i = 0; i < graphPointer->arcCount; i++) {
+        if (!embedding->used[i >> 1] || !embedding->inComponent[graphPointer->head[i]]
+            || embedding->faceOf[i] != -1) continue;
+
+        embedding->faceStart[embedding->faceCount] = count;
+        arc = i;
+        do {
+            embedding->faceOf[arc] = embedding->faceCount;
+            embedding->dartPos[arc] = count - embedding->faceStart[embedding->faceCount];
+            embedding->faceDarts[count++] = arc;
+
+            node = graphPointer->head[arc];
+            degree = embedding->rotStart[node + 1] - embedding->rotStart[node];
+            arc = embedding->rotArcs[embedding->rotStart[node] + (embedding->rotPos[REVERSE(arc)] + degree - 1) % degree];
+        } while (arc != i);
+        embedding->faceCount++;
+    }
+    embedding->faceStart[embedding->faceCount] = count;
+
+    return embedding->componentNodes - embedding->componentPairs + embedding->faceCount == 2;
+}
+
+/* ____________________________________________________________________________
+
+    planarEmbedding *createPlanarEmbedding(graph *graphPointer, char *used,
+                                           int *connected)
+
+    Creates embedding of the component of the source made of used pairs of
+    arcs (the embedding takes over used array). Connected is set to
+    boolean value if the target is in the component (-1 if it couldn't be
+    found out), the embedding isn't created if it isn't. Returns pointer to the embedding or NULL if the
+    component isn't planar or if error occurred.
+   ____________________________________________________________________________
+*/
+static planarEmbedding *createPlanarEmbedding(graph *graphPointer, char *used, int *connected) {
+    int i;
+    int darts;
+    planarEmbedding *embedding;
+
+    *connected = -1;
+    embedding = calloc(1, sizeof(planarEmbedding));
+    if (!embedding) {
+        free(used);
+        return NULL;
+    }
+
+    embedding->graphPointer = graphPointer;
+    embedding->used = used;
+    embedding->inComponent = calloc(graphPointer->nodeCount, sizeof(char));
+    if (!embedding->inComponent) {
+        freePlanarEmbedding(&embedding);
+        return NULL;
+    }
+
+    *connected = planarComponent(embedding);
+    if (*connected != 1) {
+        freePlanarEmbedding(&embedding);
+        return NULL;
+    }
+
+    darts = 2 * embedding->componentPairs;
+    embedding->x = malloc(graphPointer->nodeCount * sizeof(double));
+    embedding->y = malloc(graphPointer->nodeCount * sizeof(double));
+    embedding->rotStart = malloc((graphPointer->nodeCount + 1) * sizeof(int));
+    embedding->rotArcs = malloc((darts + 1) * sizeof(int));
+    embedding->rotPos = malloc((graphPointer->arcCount + 1) * sizeof(int));
+    embedding->faceStart = malloc((darts + 2) * sizeof(int));
+    embedding->faceDarts = malloc((darts + 1) * sizeof(int));
+    embedding->faceOf = malloc((graphPointer->arcCount + 1) * sizeof(int));
+    embedding->dartPos = malloc((graphPointer->arcCount + 1) * sizeof(int));
+    if (!embedding->x || !embedding->y || !embedding->rotStart || !embedding->rotArcs || !embedding->rotPos
+        || !embedding->faceStart || !embedding->faceDarts || !embedding->faceOf || !embedding->dartPos
+        || !planarRotations(embedding) || !planarCheckCrossings(embedding)) {
+        freePlanarEmbedding(&embedding);
+        return NULL;
+    }
+
+    for (i = 0; i < graphPointer->arcCount; i++) embedding->faceOf[i] = -1;
+    if (!planarFaces(embedding)) {
+        freePlanarEmbedding(&embedding);
+        return NULL;
+    }
+
+    /* the dual cut open has at most two vertices for every face */
+    embedding->seen = calloc(2 * embedding->faceCount, sizeof(int));
+    embedding->parent = malloc(2 * embedding->faceCount * sizeof(int));
+    embedding->regionMark = calloc(2 * embedding->faceCount, sizeof(int));
+    embedding->lowMark = calloc(2 * embedding->faceCount, sizeof(int));
+    embedding->lowIn = malloc(2 * embedding->faceCount * sizeof(int));
+    embedding->lowOut = malloc(2 * embedding->faceCount * sizeof(int));
+    embedding->highMark = calloc(2 * embedding->faceCount, sizeof(int));
+    embedding->highIn = malloc(2 * embedding->faceCount * sizeof(int));
+    embedding->highOut = malloc(2 * embedding->faceCount * sizeof(int));
+    embedding->queue = malloc(2 * embedding->faceCount * sizeof(int));
+    if (!embedding->seen || !embedding->parent || !embedding->regionMark || !embedding->lowMark
+        || !embedding->lowIn || !embedding->lowOut || !embedding->highMark || !embedding->highIn
+        || !embedding->highOut || !embedding->queue) {
+        freePlanarEmbedding(&embedding);
+        return NULL;
+    }
+
+    return embedding;
+}
+
+/* ____________________________________________________________________________
+
+    void planarAddPort(planarEmbedding *embedding, int vertex, int dart,
+                       int *count)
+
+    Adds the dart as the next port of the vertex of the dual cut open.
+   ____________________________________________________________________________
+*/
+static void planarAddPort(planarEmbedding *embedding, int vertex, int dart, int *count) {
+    embedding->portDart[*count] = dart;
+    embedding->portVertex[*count] = vertex;
+
+    /* darts of the path are in both copies, the others have single port */
+    if (!embedding->isPathDart[dart] || vertex < embedding->faceCount) embedding->portLeft[dart] = *count;
+    if (!embedding->isPathDart[dart] || vertex >= embedding->faceCount) embedding->portRight[dart] = *count;
+    (*count)++;
+}
+
+/* ____________________________________________________________________________
+
+    void planarAddRange(planarEmbedding *embedding, int vertex, int face,
+                        int start, int end, int *count)
+
+    Adds darts of the face from position start up to position end
+    (excluded, positions go around the face) as ports of the vertex.
+   ____________________________________________________________________________
+*/
+static void planarAddRange(planarEmbedding *embedding, int vertex, int face, int start, int end, int *count) {
+    int size = embedding->faceStart[face + 1] - embedding->faceStart[face];
+
+    start %= size;
+    end %= size;
+    while (start != end) {
+        planarAddPort(embedding, vertex, embedding->faceDarts[embedding->faceStart[face] + start], count);
+        start = (start + 1) % size;
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int planarCutOpen(planarEmbedding *embedding, int *pathDarts,
+                      int sourceDart, int targetDart)
+
+    Cuts the dual open along the path of faces (pathFaces of the embedding,
+    pathDarts[i] is the dart crossed from face i to face i + 1). The cut
+    goes from the source, which is in the corner before sourceDart of the
+    first face, to the target in the corner before targetDart of the last
+    face. Darts of every path face from the side where the cut comes from
+    to the side where it leaves (counterclockwise) go to the right copy,
+    the others to the left one, the crossed darts to both of them. Ports
+    of the left copy start with the leaving dart, ports of the right copy
+    with the coming one. Returns FAILURE if error occurred.
+   ____________________________________________________________________________
+*/
+static int planarCutOpen(planarEmbedding *embedding, int *pathDarts, int sourceDart, int targetDart) {
+    int i;
+    int face;
+    int come;
+    int leave;
+    int count = 0;
+    int ports;
+    int last = embedding->pathLength - 1;
+    graph *graphPointer = embedding->graphPointer;
+
+    embedding->vertexCount = embedding->faceCount + embedding->pathLength;
+    ports = embedding->faceStart[embedding->faceCount] + 2 * last;
+
+    embedding->pathIndex = malloc(embedding->faceCount * sizeof(int));
+    embedding->isPathDart = calloc(graphPointer->arcCount, sizeof(char));
+    embedding->portStart = malloc((embedding->vertexCount + 1) * sizeof(int));
+    embedding->portDart = malloc(ports * sizeof(int));
+    embedding->portVertex = malloc(ports * sizeof(int));
+    embedding->portTwin = malloc(ports * sizeof(int));
+    embedding->portLeft = malloc(graphPointer->arcCount * sizeof(int));
+    embedding->portRight = malloc(graphPointer->arcCount * sizeof(int));
+    if (!embedding->pathIndex || !embedding->isPathDart || !embedding->portStart || !embedding->portDart
+        || !embedding->portVertex || !embedding->portTwin || !embedding->portLeft || !embedding->portRight) {
+        return FAILURE;
+    }
+
+    for (i = 0; i < embedding->faceCount; i++) embedding->pathIndex[i] = -1;
+    for (i = 0; i < embedding->pathLength; i++) embedding->pathIndex[embedding->pathFaces[i]] = i;
+    for (i = 0; i < last; i++) {
+        embedding->isPathDart[pathDarts[i]] = 1;
+        embedding->isPathDart[REVERSE(pathDarts[i])] = 1;
+    }
+
+    for (face = 0; face < embedding->vertexCount; face++) {
+        embedding->portStart[face] = count;
+        if (face < embedding->faceCount && embedding->pathIndex[face] == -1) {
+            for (i = embedding->faceStart[face]; i < embedding->faceStart[face + 1]; i++) {
+                planarAddPort(embedding, face, embedding->faceDarts[i], &count);
+            }
+            continue;
+        }
+
+        /* path face i, positions of the darts where the cut comes and leaves, corners are
+           before the position */
+        i = face < embedding->faceCount ? embedding->pathIndex[face] : face - embedding->faceCount;
+        come = i > 0 ? embedding->dartPos[REVERSE(pathDarts[i - 1])] : embedding->dartPos[sourceDart];
+        leave = i < last ? embedding->dartPos[pathDarts[i]] : embedding->dartPos[targetDart];
+
+        if (face < embedding->faceCount) {
+            if (i < last) planarAddPort(embedding, face, pathDarts[i], &count);
+            planarAddRange(embedding, face, embedding->pathFaces[i], i < last ? leave + 1 : leave, come, &count);
+            if (i > 0) planarAddPort(embedding, face, REVERSE(pathDarts[i - 1]), &count);
+        } else {
+            if (i > 0) planarAddPort(embedding, face, REVERSE(pathDarts[i - 1]), &count);
+            planarAddRange(embedding, face, embedding->pathFaces[i], i > 0 ? come + 1 : come, leave, &count);
+            if (i < last) planarAddPort(embedding, face, pathDarts[i], &count);
+        }
+    }
+    embedding->portStart[embedding->vertexCount] = count;
+
+    for (i = 0; i < count; i++) {
+        embedding->portTwin[i] = embedding->portVertex[i] >= embedding->faceCount
+                                 ? embedding->portRight[REVERSE(embedding->portDart[i])]
+                                 : embedding->portLeft[REVERSE(embedding->portDart[i])];
+    }
+
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int planarIsSlit(planarEmbedding *embedding, int vertex)
+
+    Returns boolean value if the vertex is copy of a path face, such vertex
+    has a gap after its last port.
+   ____________________________________________________________________________
+*/
+static int planarIsSlit(planarEmbedding *embedding, int vertex) {
+    return vertex >= embedding->faceCount || embedding->pathIndex[vertex] != -1;
+}
+
+/* ____________________________________________________________________________
+
+    int planarBetween(int position, int from, int to, int size)
+
+    Returns boolean value if the position is strictly between positions
+    from and to, going up from "from" around the size.
+   ____________________________________________________________________________
+*/
+static int planarBetween(int position, int from, int to, int size) {
+    int offset = (position - from + size) % size;
+
+    return offset > 0 && offset < (to - from + size) % size;
+}
+
+/* ____________________________________________________________________________
+
+    int planarAllowed(planarEmbedding *embedding, int vertex, int port)
+
+    Returns boolean value if the port of the vertex leads into the current
+    region, which is on the right side of its low path and on the left side
+    of its high path. Ports of the paths themselves are allowed.
+   ____________________________________________________________________________
+*/
+static int planarAllowed(planarEmbedding *embedding, int vertex, int port) {
+    int position = port - embedding->portStart[vertex];
+    int size = embedding->portStart[vertex + 1] - embedding->portStart[vertex] + planarIsSlit(embedding, vertex);
+
+    if (embedding->lowMark[vertex] == embedding->region && position != embedding->lowIn[vertex]
+        && position != embedding->lowOut[vertex]
+        && !planarBetween(position, embedding->lowIn[vertex], embedding->lowOut[vertex], size)) return 0;
+
+    if (embedding->highMark[vertex] == embedding->region && position != embedding->highIn[vertex]
+        && position != embedding->highOut[vertex]
+        && !planarBetween(position, embedding->highOut[vertex], embedding->highIn[vertex], size)) return 0;
+
+    return 1;
+}
+
+/* ____________________________________________________________________________
+
+    void planarFlood(planarEmbedding *embedding, int low, int *lowPath,
+                     int lowLength, int high, int *highPath, int highLength)
+
+    Marks the region between paths of path faces low and high (triples of
+    vertex, coming and leaving position, NULL means no limit). The region
+    has both paths and everything what can be reached from copies of path
+    faces between low and high without going through the paths to their
+    wrong side.
+   ____________________________________________________________________________
+*/
+static void planarFlood(planarEmbedding *embedding, int low, int *lowPath, int lowLength, int high, int *highPath,
+                        int highLength) {
+    int i;
+    int j;
+    int vertex;
+    int next;
+    int count = 0;
+    int *mark = embedding->regionMark;
+
+    embedding->region++;
+    for (i = 0; i < lowLength; i++) {
+        vertex = lowPath[3 * i];
+        embedding->lowMark[vertex] = embedding->region;
+        embedding->lowIn[vertex] = lowPath[3 * i + 1];
+        embedding->lowOut[vertex] = lowPath[3 * i + 2];
+        if (mark[vertex] != embedding->region) embedding->queue[count++] = vertex;
+        mark[vertex] = embedding->region;
+    }
+    for (i = 0; i < highLength; i++) {
+        vertex = highPath[3 * i];
+        embedding->highMark[vertex] = embedding->region;
+        embedding->highIn[vertex] = highPath[3 * i + 1];
+        embedding->highOut[vertex] = highPath[3 * i + 2];
+        if (mark[vertex] != embedding->region) embedding->queue[count++] = vertex;
+        mark[vertex] = embedding->region;
+    }
+    for (i = low + 1; i < high; i++) {
+        vertex = embedding->pathFaces[i];
+        if (mark[vertex] != embedding->region) embedding->queue[count++] = vertex;
+        mark[vertex] = embedding->region;
+
+        vertex = embedding->faceCount + i;
+        if (mark[vertex] != embedding->region) embedding->queue[count++] = vertex;
+        mark[vertex] = embedding->region;
+    }
+
+    for (i = 0; i < count; i++) {
+        vertex = embedding->queue[i];
+        for (j = embedding->portStart[vertex]; j < embedding->portStart[vertex + 1]; j++) {
+            if (!planarAllowed(embedding, vertex, j)) continue;
+
+            next = embedding->portVertex[embedding->portTwin[j]];
+            if (mark[next] == embedding->region) continue;
+            mark[next] = embedding->region;
+            embedding->queue[count++] = next;
+        }
+    }
+}
+
+#define FLOW_TYPE int
+#define FLOW_FIELD integer
+#define FLOW_INF FLOW_INT_LIMIT
+#define FLOW_SUFFIX Int
+#include "planarVariant.h"
+
+#define FLOW_TYPE long
+#define FLOW_FIELD integer
+#define FLOW_INF FLOW_LONG_LIMIT
+#define FLOW_SUFFIX Long
+#include "planarVariant.h"
+
+#define FLOW_TYPE double
+#define FLOW_FIELD real
+#define FLOW_INF DBL_MAX
+#define FLOW_SUFFIX Real
+#include "planarVariant.h"
@@ -0,0 +1,20 @@
+#ifndef SEMESTRALKA_PLANAR_H
+#define SEMESTRALKA_PLANAR_H
+
+#include "structs.h"
+
+#define PLANAR_CELL_LIMIT 16
+#define PLANAR_TEST_LIMIT 64
+#define PLANAR_POP_LIMIT 64
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int planarFlowInt(graph *graphPointer);
+long planarFlowLong(graph *graphPointer);
+double planarFlowReal(graph *graphPointer);
+
+#endif
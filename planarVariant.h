@@ -0,0 +1,518 @@
+/* ____________________________________________________________________________
+
+    Header planarVariant.h
+    Shortest paths of the dual graph and the flow of planar graphs written
+    once for all capacity types. The header has no include guard, planar.c
+    includes it once for every variant, the macros are the same as in
+    graphVariant.h (FLOW_TYPE, FLOW_FIELD, FLOW_INF, FLOW_SUFFIX) and they
+    are undefined at the end.
+
+    Length of the dual edge is the capacity of the pair of arcs it crosses.
+    Every path between both copies of a path face is a cycle which
+    separates source from target, so its length is capacity of some cut.
+    Potentials of the vertices of the dual cut open differ by the minimal
+    cut between both copies of every path face, flow of the arc is then the
+    potential of its left face minus the potential of its right face.
+   ____________________________________________________________________________
+*/
+
+#define FLOW_JOIN(name, suffix) name##suffix
+#define FLOW_EXPAND(name, suffix) FLOW_JOIN(name, suffix)
+#define FLOW_NAME(name) FLOW_EXPAND(name, FLOW_SUFFIX)
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct {
+    FLOW_TYPE *keys;
+    int *items;
+    int count;
+    int size;
+} FLOW_NAME(planarHeap);
+
+/* ____________________________________________________________________________
+
+    int planarHeapPush(planarHeap *heap, FLOW_TYPE key, int item)
+
+    Adds the item with the key into the binary heap, the heap grows when
+    it's full. Returns FAILURE if error occurred.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(planarHeapPush)(FLOW_NAME(planarHeap) *heap, FLOW_TYPE key, int item) {
+    int i;
+    int parent;
+    FLOW_TYPE *keys;
+    int *items;
+
+    if (heap->count == heap->size) {
+        keys = realloc(heap->keys, 2 * heap->size * sizeof(FLOW_TYPE));
+        if (!keys) return FAILURE;
+        heap->keys = keys;
+
+        items = realloc(heap->items, 2 * heap->size * sizeof(int));
+        if (!items) return FAILURE;
+        heap->items = items;
+        heap->size *= 2;
+    }
+
+    i = heap->count++;
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (heap->keys[parent] <= key) break;
+        heap->keys[i] = heap->keys[parent];
+        heap->items[i] = heap->items[parent];
+        i = parent;
+    }
+    heap->keys[i] = key;
+    heap->items[i] = item;
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int planarHeapPop(planarHeap *heap, FLOW_TYPE *key)
+
+    Removes the item with the smallest key from the heap, which must not
+    be empty. Returns the item, its key is stored into key.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(planarHeapPop)(FLOW_NAME(planarHeap) *heap, FLOW_TYPE *key) {
+    int i = 0;
+    int child;
+    int item = heap->items[0];
+    int lastItem;
+    FLOW_TYPE lastKey;
+
+    *key = heap->keys[0];
+    heap->count--;
+    lastKey = heap->keys[heap->count];
+    lastItem = heap->items[heap->count];
+
+    while ((child = 2 * i + 1) < heap->count) {
+        if (child + 1 < heap->count && heap->keys[child + 1] < heap->keys[child]) child++;
+        if (lastKey <= heap->keys[child]) break;
+        heap->keys[i] = heap->keys[child];
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    heap->keys[i] = lastKey;
+    heap->items[i] = lastItem;
+    return item;
+}
+
+/* ____________________________________________________________________________
+
+    int planarRelax(planarEmbedding *embedding, planarHeap *heap,
+                    FLOW_TYPE *distance, int vertex, FLOW_TYPE length,
+                    int parent)
+
+    Sets distance of the vertex to length if it wasn't seen by the current
+    search yet or if the length is shorter, parent is remembered and the
+    vertex goes into the heap. Returns FAILURE if error occurred.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(planarRelax)(planarEmbedding *embedding, FLOW_NAME(planarHeap) *heap, FLOW_TYPE *distance,
+                                  int vertex, FLOW_TYPE length, int parent) {
+    if (embedding->seen[vertex] == embedding->stamp && distance[vertex] <= length) return SUCCESS;
+
+    embedding->seen[vertex] = embedding->stamp;
+    distance[vertex] = length;
+    embedding->parent[vertex] = parent;
+    return FLOW_NAME(planarHeapPush)(heap, length, vertex);
+}
+
+/* ____________________________________________________________________________
+
+    char *planarUsedPairs(graph *graphPointer)
+
+    Returns array which has 1 for every pair of arcs with the same positive
+    capacity of both arcs, 2 for pairs with different capacities and 0 for
+    pairs without capacity, or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+static char *FLOW_NAME(planarUsedPairs)(graph *graphPointer) {
+    int i;
+    char *used;
+    FLOW_TYPE *capacity = graphPointer->capacity;
+
+    used = malloc(graphPointer->arcCount / 2 + 1);
+    if (!used) return NULL;
+
+    for (i = 0; i < graphPointer->arcCount; i += 2) {
+        if (capacity[i] != capacity[i + 1]) {
+            used[i >> 1] = 2;
+        } else {
+            used[i >> 1] = (char) (capacity[i] > 0);
+        }
+    }
+    return used;
+}
+
+/* ____________________________________________________________________________
+
+    int planarDualPath(planarEmbedding *embedding, planarHeap *heap,
+                       FLOW_TYPE *distance, int **pathDarts,
+                       int *sourceDart, int *targetDart)
+
+    Finds the shortest path of the dual graph from some face at the source
+    to some face at the target and stores it into pathFaces of the
+    embedding, pathDarts are the darts crossed by the path. SourceDart is
+    a dart of the first face which leaves the source, targetDart is a dart
+    of the last face which leaves the target. Returns FAILURE if error
+    occurred.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(planarDualPath)(planarEmbedding *embedding, FLOW_NAME(planarHeap) *heap, FLOW_TYPE *distance,
+                                     int **pathDarts, int *sourceDart, int *targetDart) {
+    int i;
+    int face = -1;
+    int dart;
+    int length = 1;
+    char *isTarget;
+    FLOW_TYPE key;
+    graph *graphPointer = embedding->graphPointer;
+    FLOW_TYPE *capacity = graphPointer->capacity;
+
+    isTarget = calloc(embedding->faceCount, sizeof(char));
+    if (!isTarget) return FAILURE;
+
+    embedding->stamp++;
+    heap->count = 0;
+    for (i = embedding->rotStart[graphPointer->target]; i < embedding->rotStart[graphPointer->target + 1]; i++) {
+        isTarget[embedding->faceOf[embedding->rotArcs[i]]] = 1;
+    }
+    for (i = embedding->rotStart[graphPointer->source]; i < embedding->rotStart[graphPointer->source + 1]; i++) {
+        if (!FLOW_NAME(planarRelax)(embedding, heap, distance, embedding->faceOf[embedding->rotArcs[i]], 0, -1)) {
+            free(isTarget);
+            return FAILURE;
+        }
+    }
+
+    while (heap->count > 0 && face == -1) {
+        dart = FLOW_NAME(planarHeapPop)(heap, &key);
+        if (key > distance[dart]) continue;
+        if (isTarget[dart]) {
+            face = dart;
+            break;
+        }
+
+        /* dart is the face here */
+        for (i = embedding->faceStart[dart]; i < embedding->faceStart[dart + 1]; i++) {
+            if (!FLOW_NAME(planarRelax)(embedding, heap, distance,
+                                        embedding->faceOf[REVERSE(embedding->faceDarts[i])],
+                                        key + capacity[embedding->faceDarts[i]], embedding->faceDarts[i])) {
+                face = -2;
+                break;
+            }
+        }
+    }
+    free(isTarget);
+    if (face < 0) return FAILURE;
+
+    for (dart = embedding->parent[face]; dart != -1; dart = embedding->parent[embedding->faceOf[dart]]) length++;
+    embedding->pathLength = length;
+    embedding->pathFaces = malloc(length * sizeof(int));
+    *pathDarts = malloc(length * sizeof(int));
+    if (!embedding->pathFaces || !*pathDarts) return FAILURE;
+
+    embedding->pathFaces[--length] = face;
+    while (embedding->parent[face] != -1) {
+        (*pathDarts)[length - 1] = embedding->parent[face];
+        face = embedding->faceOf[embedding->parent[face]];
+        embedding->pathFaces[--length] = face;
+    }
+
+    for (i = embedding->rotStart[graphPointer->source]; i < embedding->rotStart[graphPointer->source + 1]; i++) {
+        if (embedding->faceOf[embedding->rotArcs[i]] == embedding->pathFaces[0]) *sourceDart = embedding->rotArcs[i];
+    }
+    for (i = embedding->rotStart[graphPointer->target]; i < embedding->rotStart[graphPointer->target + 1]; i++) {
+        if (embedding->faceOf[embedding->rotArcs[i]] == embedding->pathFaces[embedding->pathLength - 1]) {
+            *targetDart = embedding->rotArcs[i];
+        }
+    }
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    FLOW_TYPE planarShortest(planarEmbedding *embedding, planarHeap *heap,
+                             FLOW_TYPE *distance, int source, int target,
+                             int **path, int *length)
+
+    Finds the shortest path from source to target (vertices of the dual cut
+    open) inside the current region. The path is stored into path as
+    triples of vertex, coming and leaving position (the gap for source and
+    target), length is the number of its vertices. Returns length of the
+    path or -1 if the target can't be reached or if error occurred.
+   ____________________________________________________________________________
+*/
+static FLOW_TYPE FLOW_NAME(planarShortest)(planarEmbedding *embedding, FLOW_NAME(planarHeap) *heap,
+                                           FLOW_TYPE *distance, int source, int target, int **path, int *length) {
+    int i;
+    int vertex;
+    int next;
+    int twin;
+    int leave;
+    FLOW_TYPE key;
+    FLOW_TYPE *capacity = embedding->graphPointer->capacity;
+
+    embedding->stamp++;
+    heap->count = 0;
+    if (!FLOW_NAME(planarRelax)(embedding, heap, distance, source, 0, -1)) return -1;
+
+    while (heap->count > 0) {
+        vertex = FLOW_NAME(planarHeapPop)(heap, &key);
+        if (key > distance[vertex]) continue;
+        if (vertex == target) break;
+
+        for (i = embedding->portStart[vertex]; i < embedding->portStart[vertex + 1]; i++) {
+            if (!planarAllowed(embedding, vertex, i)) continue;
+
+            twin = embedding->portTwin[i];
+            next = embedding->portVertex[twin];
+            if (embedding->regionMark[next] != embedding->region || !planarAllowed(embedding, next, twin)) continue;
+            if (!FLOW_NAME(planarRelax)(embedding, heap, distance, next, key + capacity[embedding->portDart[i]],
+                                        twin)) return -1;
+        }
+    }
+    if (embedding->seen[target] != embedding->stamp) return -1;
+
+    /* parent of the vertex is its port where the path comes */
+    *length = 1;
+    for (vertex = target; embedding->parent[vertex] != -1; vertex = embedding->portVertex[embedding->portTwin[embedding->parent[vertex]]]) {
+        (*length)++;
+    }
+    *path = malloc(3 * *length * sizeof(int));
+    if (!*path) return -1;
+
+    vertex = target;
+    leave = embedding->portStart[target + 1] - embedding->portStart[target];
+    for (i = *length - 1; i >= 0; i--) {
+        (*path)[3 * i] = vertex;
+        (*path)[3 * i + 2] = leave;
+        if (embedding->parent[vertex] == -1) {
+            (*path)[3 * i + 1] = embedding->portStart[vertex + 1] - embedding->portStart[vertex];
+            break;
+        }
+        (*path)[3 * i + 1] = embedding->parent[vertex] - embedding->portStart[vertex];
+
+        twin = embedding->portTwin[embedding->parent[vertex]];
+        vertex = embedding->portVertex[twin];
+        leave = twin - embedding->portStart[vertex];
+    }
+
+    return distance[target];
+}
+
+/* ____________________________________________________________________________
+
+    int planarDivide(planarEmbedding *embedding, planarHeap *heap,
+                     FLOW_TYPE *distance, int low, int *lowPath,
+                     int lowLength, int high, int *highPath,
+                     int highLength, FLOW_TYPE *best)
+
+    Finds the shortest paths between both copies of path faces between low
+    and high. The path of the middle face is searched in the region
+    between the paths of low and high (NULL means no limit), then it
+    limits the regions of both halves. The shortest length is kept in best.
+    Returns FAILURE if some path wasn't found or if error occurred.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(planarDivide)(planarEmbedding *embedding, FLOW_NAME(planarHeap) *heap, FLOW_TYPE *distance,
+                                   int low, int *lowPath, int lowLength, int high, int *highPath, int highLength,
+                                   FLOW_TYPE *best) {
+    int middle;
+    int length;
+    int result;
+    int *path;
+    FLOW_TYPE cut;
+
+    if (high - low < 2) return SUCCESS;
+    middle = (low + high) / 2;
+
+    planarFlood(embedding, low, lowPath, lowLength, high, highPath, highLength);
+    cut = FLOW_NAME(planarShortest)(embedding, heap, distance, embedding->pathFaces[middle],
+                                    embedding->faceCount + middle, &path, &length);
+    if (cut < 0) return FAILURE;
+    if (cut < *best) *best = cut;
+
+    result = FLOW_NAME(planarDivide)(embedding, heap, distance, low, lowPath, lowLength, middle, path, length, best)
+             && FLOW_NAME(planarDivide)(embedding, heap, distance, middle, path, length, high, highPath, highLength,
+                                        best);
+    free(path);
+    return result;
+}
+
+/* ____________________________________________________________________________
+
+    int planarPotentials(planarEmbedding *embedding, planarHeap *heap,
+                         FLOW_TYPE *distance, FLOW_TYPE cut)
+
+    Finds potentials of all vertices of the dual cut open, potential of the
+    right copy of every path face is the potential of the left copy plus
+    the cut and potentials of the ends of every dual edge differ at most
+    by its length. They are distances from the first path face, the edge
+    from the right copy to the left one is negative, so vertices can be
+    settled again. Returns FAILURE if the search doesn't end (the cut isn't
+    minimal), if some vertex can't be reached or if error occurred.
+    Floating capacities get small slack in both edges between the copies,
+    otherwise rounding could make the cycle of the cut negative.
+   ____________________________________________________________________________
+*/
+static int FLOW_NAME(planarPotentials)(planarEmbedding *embedding, FLOW_NAME(planarHeap) *heap, FLOW_TYPE *distance,
+                                       FLOW_TYPE cut) {
+    int i;
+    int vertex;
+    int next;
+    long pops = 0;
+    FLOW_TYPE key;
+    FLOW_TYPE slack = 0;
+    FLOW_TYPE *capacity = embedding->graphPointer->capacity;
+
+    /* the cast is zero for integer types */
+    if ((FLOW_TYPE) 0.5 > 0) slack = cut * FLOW_EPSILON / 4;
+
+    embedding->stamp++;
+    heap->count = 0;
+    if (!FLOW_NAME(planarRelax)(embedding, heap, distance, embedding->pathFaces[0], 0, -1)) return FAILURE;
+
+    while (heap->count > 0) {
+        vertex = FLOW_NAME(planarHeapPop)(heap, &key);
+        if (key > distance[vertex]) continue;
+        if (++pops > (long) PLANAR_POP_LIMIT * (embedding->portStart[embedding->vertexCount] + embedding->vertexCount)) {
+            return FAILURE;
+        }
+
+        for (i = embedding->portStart[vertex]; i < embedding->portStart[vertex + 1]; i++) {
+            if (!FLOW_NAME(planarRelax)(embedding, heap, distance, embedding->portVertex[embedding->portTwin[i]],
+                                        key + capacity[embedding->portDart[i]], -1)) return FAILURE;
+        }
+
+        if (vertex >= embedding->faceCount) {
+            next = embedding->pathFaces[vertex - embedding->faceCount];
+            if (!FLOW_NAME(planarRelax)(embedding, heap, distance, next, key - cut + slack, -1)) return FAILURE;
+        } else if (embedding->pathIndex[vertex] != -1) {
+            next = embedding->faceCount + embedding->pathIndex[vertex];
+            if (!FLOW_NAME(planarRelax)(embedding, heap, distance, next, key + cut + slack, -1)) return FAILURE;
+        }
+    }
+
+    for (i = 0; i < embedding->vertexCount; i++) {
+        if (embedding->seen[i] != embedding->stamp) return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    FLOW_TYPE planarSetFlow(planarEmbedding *embedding, FLOW_TYPE *distance,
+                            FLOW_TYPE cut)
+
+    Sets residual capacities of the arcs of the component from the
+    potentials, the flow goes out of the source. Floating flow which is
+    almost the capacity is rounded to it, so the cut stays saturated.
+    Returns the flow or -1 if the flow from the source isn't the cut
+    (rounding of floating capacities went wrong).
+   ____________________________________________________________________________
+*/
+static FLOW_TYPE FLOW_NAME(planarSetFlow)(planarEmbedding *embedding, FLOW_TYPE *distance, FLOW_TYPE cut) {
+    int i;
+    int port;
+    FLOW_TYPE flow;
+    FLOW_TYPE total = 0;
+    FLOW_TYPE sign = 1;
+    FLOW_TYPE difference;
+    FLOW_TYPE tolerance = 0;
+    graph *graphPointer = embedding->graphPointer;
+    FLOW_TYPE *capacity = graphPointer->capacity;
+    FLOW_TYPE *residual = graphPointer->residual;
+
+    for (i = embedding->rotStart[graphPointer->source]; i < embedding->rotStart[graphPointer->source + 1]; i++) {
+        port = embedding->portLeft[embedding->rotArcs[i]];
+        total += distance[embedding->portVertex[port]] - distance[embedding->portVertex[embedding->portTwin[port]]];
+    }
+    if (total < 0) sign = -1;
+    if ((FLOW_TYPE) 0.5 > 0) tolerance = cut * FLOW_EPSILON;
+
+    difference = sign * total - cut;
+    if (difference < 0) difference = -difference;
+    if (difference > tolerance) return -1;
+
+    for (i = 0; i < graphPointer->arcCount; i += 2) {
+        if (!embedding->used[i >> 1] || !embedding->inComponent[graphPointer->head[i]]) continue;
+
+        port = embedding->portLeft[i];
+        flow = sign * (distance[embedding->portVertex[port]] - distance[embedding->portVertex[embedding->portTwin[port]]]);
+        if (flow > capacity[i] - tolerance) flow = capacity[i];
+        if (flow < tolerance - capacity[i]) flow = -capacity[i];
+        residual[i] = capacity[i] - flow;
+        residual[i + 1] = capacity[i] + flow;
+    }
+
+    /* any arc can be changed, so graphResetResidual must reset all of them */
+    graphPointer->touchedCount = -1;
+    return cut;
+}
+
+/* ____________________________________________________________________________
+
+    FLOW_TYPE planarFlow(graph *graphPointer)
+
+    Finds maximal flow from source to target of the graph if the component
+    of the source is planar (see planar.c) and sets residual capacities of
+    its arcs, the graph must be without flow. Returns the flow, 0 without
+    changing the graph if the target can't be reached, or -1 if the graph
+    isn't planar, if some capacities differ in both directions or if error
+    occurred.
+   ____________________________________________________________________________
+*/
+FLOW_TYPE FLOW_NAME(planarFlow)(graph *graphPointer) {
+    int connected;
+    int sourceDart = -1;
+    int targetDart = -1;
+    int *pathDarts = NULL;
+    char *used;
+    FLOW_TYPE flow = -1;
+    FLOW_TYPE best = FLOW_INF;
+    FLOW_TYPE *distance;
+    FLOW_NAME(planarHeap) heap;
+    planarEmbedding *embedding;
+
+    used = FLOW_NAME(planarUsedPairs)(graphPointer);
+    if (!used) return -1;
+
+    embedding = createPlanarEmbedding(graphPointer, used, &connected);
+    if (!embedding) return connected == 0 ? 0 : -1;
+
+    heap.count = 0;
+    heap.size = 2 * embedding->faceCount;
+    heap.keys = malloc(heap.size * sizeof(FLOW_TYPE));
+    heap.items = malloc(heap.size * sizeof(int));
+    distance = malloc(2 * embedding->faceCount * sizeof(FLOW_TYPE));
+
+    if (heap.keys && heap.items && distance
+        && FLOW_NAME(planarDualPath)(embedding, &heap, distance, &pathDarts, &sourceDart, &targetDart)
+        && planarCutOpen(embedding, pathDarts, sourceDart, targetDart)
+        && FLOW_NAME(planarDivide)(embedding, &heap, distance, -1, NULL, 0, embedding->pathLength, NULL, 0, &best)
+        && FLOW_NAME(planarPotentials)(embedding, &heap, distance, best)) {
+        flow = FLOW_NAME(planarSetFlow)(embedding, distance, best);
+    }
+
+    free(distance);
+    free(heap.items);
+    free(heap.keys);
+    free(pathDarts);
+    freePlanarEmbedding(&embedding);
+    return flow;
+}
+
+#undef FLOW_NAME
+#undef FLOW_EXPAND
+#undef FLOW_JOIN
+#undef FLOW_TYPE
+#undef FLOW_FIELD
+#undef FLOW_INF
+#undef FLOW_SUFFIX
@@ -0,0 +1,376 @@
+/* ____________________________________________________________________________
+
+    Module prune.c
+    This module contains functions which find the core of the graph for one
+    query between sets of sources and targets. Only nodes which are
+    reachable from some source, from which some target is reachable, and
+    which don't lie in dead end trees can carry some flow, so the graph for
+    the algorithm is built only over them.
+   ____________________________________________________________________________
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "prune.h"
+#include "intQueue.h"
+#include "inputOutput.h"
+
+/* ____________________________________________________________________________
+
+    void pruneMarkReachable(int start, int *first, int *neighbours,
+                            char *state, char flag, intQueue *queue)
+
+    Runs bfs from the start node over adjacency described by first and
+    neighbours arrays and sets the flag in the state of all reached nodes.
+    If the start node has the flag already, its nodes were reached before.
+   ____________________________________________________________________________
+*/
+static void pruneMarkReachable(int start, int *first, int *neighbours, char *state, char flag,
+                               intQueue *queue) {
+    int i;
+    int node;
+
+    if (state[start] & flag) return;
+    state[start] |= flag;
+    intQueueEnque(queue, start);
+
+    while (!intQueueIsEmpty(queue)) {
+        intQueueDeque(&node, queue);
+
+        for (i = first[node]; i < first[node + 1]; i++) {
+            if (!(state[neighbours[i]] & flag)) {
+                state[neighbours[i]] |= flag;
+                intQueueEnque(queue, neighbours[i]);
+            }
+        }
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int pruneCoreDegree(int node, int *outFirst, int *outNeighbours,
+                        int *inFirst, int *inNeighbours, char *state,
+                        int *stamp, int mark, int maxDegree)
+
+    Counts distinct neighbours of the node (in both directions) which are
+    still in the core. Stops counting when maxDegree is exceeded, because
+    callers only need to know if the node is a dead end. Stamp array is used
+    to skip parallel edges, mark must be different in every call.
+   ____________________________________________________________________________
+*/
+static int pruneCoreDegree(int node, int *outFirst, int *outNeighbours, int *inFirst, int *inNeighbours,
+                           char *state, int *stamp, int mark, int maxDegree) {
+    int i;
+    int neighbour;
+    int degree = 0;
+
+    for (i = outFirst[node]; i < outFirst[node + 1] && degree <= maxDegree; i++) {
+        neighbour = outNeighbours[i];
+        if (state[neighbour] == REACHED_BOTH && stamp[neighbour] != mark) {
+            stamp[neighbour] = mark;
+            degree++;
+        }
+    }
+    for (i = inFirst[node]; i < inFirst[node + 1] && degree <= maxDegree; i++) {
+        neighbour = inNeighbours[i];
+        if (state[neighbour] == REACHED_BOTH && stamp[neighbour] != mark) {
+            stamp[neighbour] = mark;
+            degree++;
+        }
+    }
+
+    return degree;
+}
+
+/* ____________________________________________________________________________
+
+    void pruneDeadEnds(int count, char *isTerminal, int *outFirst,
+                       int *outNeighbours, int *inFirst, int *inNeighbours,
+                       char *state, intQueue *queue)
+
+    Removes dangling trees from the core. Node (other than sources and
+    targets, which are marked in isTerminal) which has at most one distinct
+    neighbour in the core can't lie on any simple path from source to
+    target. Removing it can make its neighbour a dead end too, so the
+    neighbours are checked again.
+   ____________________________________________________________________________
+*/
+static void pruneDeadEnds(int count, char *isTerminal, int *outFirst, int *outNeighbours, int *inFirst,
+                          int *inNeighbours, char *state, intQueue *queue) {
+    int i;
+    int j;
+    int node;
+    int neighbour;
+    int mark = 0;
+    int *stamp;
+
+    stamp = malloc(count * sizeof(int));
+    if (!stamp) return;
+    for (i = 0; i < count; i++) stamp[i] = -1;
+
+    for (i = 0; i < count; i++) {
+        if (state[i] != REACHED_BOTH || isTerminal[i]) continue;
+        if (pruneCoreDegree(i, outFirst, outNeighbours, inFirst, inNeighbours, state, stamp, mark++, 1) <= 1) {
+            intQueueEnque(queue, i);
+        }
+    }
+
+    while (!intQueueIsEmpty(queue)) {
+        intQueueDeque(&node, queue);
+        if (state[node] != REACHED_BOTH) continue;
+        state[node] = 0;
+
+        /* neighbours of removed node may have become dead ends */
+        for (j = 0; j < 2; j++) {
+            for (i = j ? inFirst[node] : outFirst[node]; i < (j ? inFirst[node + 1] : outFirst[node + 1]); i++) {
+                neighbour = j ? inNeighbours[i] : outNeighbours[i];
+                if (state[neighbour] != REACHED_BOTH || isTerminal[neighbour]) continue;
+
+                if (pruneCoreDegree(neighbour, outFirst, outNeighbours, inFirst, inNeighbours,
+                                    state, stamp, mark++, 1) <= 1) {
+                    intQueueEnque(queue, neighbour);
+                }
+            }
+        }
+    }
+
+    free(stamp);
+}
+
+/* ____________________________________________________________________________
+
+    graphNode *moveGraphNode(graphNode *oldNode)
+
+    Creates copy of the node which takes over wkt of the old node, so the
+    wkt is never held twice. Old node is left without wkt. Returns pointer
+    to the copy or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+graphNode *moveGraphNode(graphNode *oldNode) {
+    graphNode *newNode;
+
+    if (!oldNode) return NULL;
+
+    newNode = calloc(1, sizeof(graphNode));
+    if (!newNode) return NULL;
+
+    newNode->id = oldNode->id;
+    newNode->index = oldNode->index;
+    newNode->wkt = oldNode->wkt;
+    oldNode->wkt = NULL;
+
+    return newNode;
+}
+
+/* ____________________________________________________________________________
+
+    int pruneFillAdjacency(hashTable *nodesTable, hashTable *edgesTable,
+                           int *outFirst, int **outNeighbours,
+                           int *inFirst, int **inNeighbours)
+
+    Creates forward and backward adjacency arrays (indexed by node->index)
+    from edges which can carry some flow, undirected edges are added in
+    both directions. Edges without capacity, loops and edges with unknown
+    nodes are skipped. First arrays must be zeroed and
+    have one more item than is the number of nodes. Returns boolean value
+    if it was successful.
+   ____________________________________________________________________________
+*/
+static int pruneFillAdjacency(hashTable *nodesTable, hashTable *edgesTable, int *outFirst, int **outNeighbours,
+                              int *inFirst, int **inNeighbours) {
+    int i;
+    int j;
+    int count = nodesTable->filledItems;
+    int edgeCount = 0;
+    int *edgeSource;
+    int *edgeTarget;
+    graphNode *sourceNode;
+    graphNode *targetNode;
+    graphEdge *edgePointer;
+
+    edgeSource = malloc((2 * edgesTable->filledItems + 1) * sizeof(int));
+    edgeTarget = malloc((2 * edgesTable->filledItems + 1) * sizeof(int));
+    if (!edgeSource || !edgeTarget) {
+        free(edgeSource);
+        free(edgeTarget);
+        return FAILURE;
+    }
+
+    for (i = 0; i < edgesTable->size; i++) {
+        for (j = 0; j < edgesTable->array[i]->filledItems; j++) {
+            edgePointer = arrayListGetPointer(edgesTable->array[i], j);
+            if (edgePointer->capacity <= 0 || edgePointer->source == edgePointer->target) continue;
+
+            sourceNode = hashTableGetElement(edgePointer->source, nodesTable);
+            targetNode = hashTableGetElement(edgePointer->target, nodesTable);
+            if (!sourceNode || !targetNode) continue;
+
+            edgeSource[edgeCount] = sourceNode->index;
+            edgeTarget[edgeCount] = targetNode->index;
+            outFirst[sourceNode->index + 1]++;
+            inFirst[targetNode->index + 1]++;
+            edgeCount++;
+
+            if (edgePointer->isUndirected) {
+                edgeSource[edgeCount] = targetNode->index;
+                edgeTarget[edgeCount] = sourceNode->index;
+                outFirst[targetNode->index + 1]++;
+                inFirst[sourceNode->index + 1]++;
+                edgeCount++;
+            }
+        }
+    }
+
+    *outNeighbours = malloc((edgeCount + 1) * sizeof(int));
+    *inNeighbours = malloc((edgeCount + 1) * sizeof(int));
+    if (!*outNeighbours || !*inNeighbours) {
+        free(edgeSource);
+        free(edgeTarget);
+        return FAILURE;
+    }
+
+    for (i = 0; i < count; i++) {
+        outFirst[i + 1] += outFirst[i];
+        inFirst[i + 1] += inFirst[i];
+    }
+
+    /* after the fill first[i] points to the end of neighbours of the node i,
+       so the arrays are shifted back afterwards */
+    for (i = 0; i < edgeCount; i++) {
+        (*outNeighbours)[outFirst[edgeSource[i]]++] = edgeTarget[i];
+        (*inNeighbours)[inFirst[edgeTarget[i]]++] = edgeSource[i];
+    }
+    for (i = count; i > 0; i--) {
+        outFirst[i] = outFirst[i - 1];
+        inFirst[i] = inFirst[i - 1];
+    }
+    outFirst[0] = 0;
+    inFirst[0] = 0;
+
+    free(edgeSource);
+    free(edgeTarget);
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    hashTable *pruneCreateCore(graphNode **nodeList, int count, char *state)
+
+    Creates new hashTable with copies of the nodes which have REACHED_BOTH
+    state, the copies take over wkt of the nodes (see moveGraphNode). Returns pointer to the hashTable or NULL if error occurred.
+   ____________________________________________________________________________
+*/
+static hashTable *pruneCreateCore(graphNode **nodeList, int count, char *state) {
+    int i;
+    int coreCount = 0;
+    graphNode *nodePointer;
+    hashTable *core;
+
+    for (i = 0; i < count; i++) {
+        if (state[i] == REACHED_BOTH) coreCount++;
+    }
+
+    core = createHashTable(coreCount + 1, sizeof(graphNode));
+    if (!core) return NULL;
+
+    for (i = 0; i < count; i++) {
+        if (state[i] != REACHED_BOTH) continue;
+
+        nodePointer = moveGraphNode(nodeList[i]);
+        if (!nodePointer) {
+            freeHashTable(&core);
+            return NULL;
+        }
+        hashTableAddUncheckedElement(nodePointer, nodePointer->id, core);
+    }
+
+    return core;
+}
+
+/* ____________________________________________________________________________
+
+    hashTable *pruneNodes(hashTable *nodesTable, hashTable *edgesTable,
+                          graphTerminal *sources, int sourceCount,
+                          graphTerminal *targets, int targetCount)
+
+    Finds nodes which are reachable from some source node and from which
+    some target node is reachable, then strips dead end trees. Returns new
+    hashTable containing copies of the remaining nodes (sources and
+    targets are always present) or NULL if error occurred. The copies take
+    over wkt of the nodes, nodesTable is meant to be freed afterwards.
+   ____________________________________________________________________________
+*/
+hashTable *pruneNodes(hashTable *nodesTable, hashTable *edgesTable, graphTerminal *sources, int sourceCount,
+                      graphTerminal *targets, int targetCount) {
+    int i;
+    int j;
+    int count = 0;
+    int index;
+    int *outFirst;
+    int *inFirst;
+    int *outNeighbours = NULL;
+    int *inNeighbours = NULL;
+    char *state;
+    char *isTerminal;
+    graphNode **nodeList;
+    graphNode *nodePointer;
+    intQueue *queue;
+    hashTable *core = NULL;
+
+    if (!nodesTable || !edgesTable || !sources || !targets) return NULL;
+    for (i = 0; i < sourceCount + targetCount; i++) {
+        if (!hashTableContains(i < sourceCount ? sources[i].id : targets[i - sourceCount].id, nodesTable)) {
+            return NULL;
+        }
+    }
+
+    nodeList = malloc((nodesTable->filledItems + 1) * sizeof(graphNode *));
+    outFirst = calloc(nodesTable->filledItems + 1, sizeof(int));
+    inFirst = calloc(nodesTable->filledItems + 1, sizeof(int));
+    state = calloc(nodesTable->filledItems + 1, sizeof(char));
+    isTerminal = calloc(nodesTable->filledItems + 1, sizeof(char));
+    queue = createIntQueue(INITIAL_SIZE);
+
+    if (nodeList && outFirst && inFirst && state && isTerminal && queue) {
+        /* give every node dense index, so the adjacency can be stored in arrays */
+        for (i = 0; i < nodesTable->size; i++) {
+            for (j = 0; j < nodesTable->array[i]->filledItems; j++) {
+                nodePointer = arrayListGetPointer(nodesTable->array[i], j);
+                nodePointer->index = count;
+                nodeList[count++] = nodePointer;
+            }
+        }
+
+        if (pruneFillAdjacency(nodesTable, edgesTable, outFirst, &outNeighbours, inFirst, &inNeighbours)) {
+            for (i = 0; i < sourceCount; i++) {
+                index = ((graphNode *) hashTableGetElement(sources[i].id, nodesTable))->index;
+                pruneMarkReachable(index, outFirst, outNeighbours, state, REACHED_FORWARD, queue);
+                isTerminal[index] = 1;
+            }
+            for (i = 0; i < targetCount; i++) {
+                index = ((graphNode *) hashTableGetElement(targets[i].id, nodesTable))->index;
+                pruneMarkReachable(index, inFirst, inNeighbours, state, REACHED_BACKWARD, queue);
+                isTerminal[index] = 1;
+            }
+
+            /* sources and targets are always kept, even if there is no path between them */
+            for (i = 0; i < count; i++) {
+                if (isTerminal[i]) state[i] = REACHED_BOTH;
+            }
+
+            pruneDeadEnds(count, isTerminal, outFirst, outNeighbours, inFirst, inNeighbours, state, queue);
+
+            core = pruneCreateCore(nodeList, count, state);
+        }
+    }
+
+    free(nodeList);
+    free(outFirst);
+    free(outNeighbours);
+    free(inFirst);
+    free(inNeighbours);
+    free(state);
+    free(isTerminal);
+    intQueueFreeQueue(&queue);
+
+    return core;
+}
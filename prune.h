@@ -0,0 +1,20 @@
+#ifndef SEMESTRALKA_PRUNE_H
+#define SEMESTRALKA_PRUNE_H
+
+#include "structs.h"
+
+#define REACHED_FORWARD 1
+#define REACHED_BACKWARD 2
+#define REACHED_BOTH 3
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+hashTable *pruneNodes(hashTable *nodesTable, hashTable *edgesTable, graphTerminal *sources, int sourceCount,
+                      graphTerminal *targets, int targetCount);
+graphNode *moveGraphNode(graphNode *oldNode);
+
+#endif
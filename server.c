@@ -0,0 +1,577 @@
+/* ____________________________________________________________________________
+
+    Module server.c
+    This module keeps the graph loaded and answers queries on local Unix
+    socket, so every query doesn't pay for loading and building the graph.
+    The graph is built over all loaded nodes (not pruned), because source
+    and target differ between queries. Connections are served by a pool of
+    worker threads, every worker solves its own view of the graph (see
+    graphCreateView), the shared graph is guarded by read-write lock and it
+    is replaced by RELOAD command. Protocol is line based, every command is
+    answered by one line which starts with OK or ERR:
+        FLOW <source> <target>  - OK <flow>
+        CUT <source> <target>   - OK <flow> <count> <edge id> ...
+        RELOAD                  - OK <nodes> <arcs>, files are loaded again
+        SHUTDOWN                - OK, the server stops
+        QUIT                    - connection is closed
+    The server stops after SHUTDOWN command or SIGINT or SIGTERM signal,
+    the socket file is removed then.
+   ____________________________________________________________________________
+*/
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "graph.h"
+#include "hashTable.h"
+#include "loader.h"
+
+#ifdef __unix__
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct {
+    serverConfig *config;
+    hashTable *nodesTable;
+    hashTable *edgesTable;
+    graph *graphPointer;
+    int generation;
+    pthread_rwlock_t graphLock;
+    pthread_mutex_t reloadLock;
+    int connections[SERVER_QUEUE_SLOTS];
+    int first;
+    int count;
+    int stopped;
+    pthread_mutex_t queueLock;
+    pthread_cond_t notEmpty;
+} serverState;
+
+typedef struct {
+    serverState *state;
+    graph *view;
+    int generation;
+} serverWorker;
+
+/* set by signal handler, SHUTDOWN command sets stopped of serverState */
+static volatile sig_atomic_t serverStopped = 0;
+
+/* ____________________________________________________________________________
+
+    void serverSignal(int signalNumber)
+
+    Signal handler, asks the server to stop.
+   ____________________________________________________________________________
+*/
+static void serverSignal(int signalNumber) {
+    (void) signalNumber;
+    serverStopped = 1;
+}
+
+/* ____________________________________________________________________________
+
+    int serverIsStopped(serverState *state)
+
+    Returns boolean value if the server was asked to stop.
+   ____________________________________________________________________________
+*/
+static int serverIsStopped(serverState *state) {
+    int stopped;
+
+    pthread_mutex_lock(&state->queueLock);
+    stopped = state->stopped || serverStopped;
+    pthread_mutex_unlock(&state->queueLock);
+    return stopped;
+}
+
+/* ____________________________________________________________________________
+
+    void serverStop(serverState *state)
+
+    Asks the server to stop and wakes up all waiting workers.
+   ____________________________________________________________________________
+*/
+static void serverStop(serverState *state) {
+    pthread_mutex_lock(&state->queueLock);
+    state->stopped = 1;
+    pthread_cond_broadcast(&state->notEmpty);
+    pthread_mutex_unlock(&state->queueLock);
+}
+
+/* ____________________________________________________________________________
+
+    int serverWrite(int client, char *text)
+
+    Writes whole text to the client. Returns FAILURE if the connection
+    failed.
+   ____________________________________________________________________________
+*/
+static int serverWrite(int client, char *text) {
+    size_t length = strlen(text);
+    ssize_t written;
+
+    while (length > 0) {
+        written = write(client, text, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return FAILURE;
+        text += written;
+        length -= written;
+    }
+
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    int serverReload(serverState *state)
+
+    Loads node file and edge file again and builds new graph. The graph
+    is swapped under write lock, so running queries finish on the old
+    graph and workers create new views with their next query. Returns
+    FAILURE if the files can't be loaded, the old graph is kept then.
+   ____________________________________________________________________________
+*/
+static int serverReload(serverState *state) {
+    hashTable *nodesTable = NULL;
+    hashTable *edgesTable = NULL;
+    hashTable *oldNodes;
+    hashTable *oldEdges;
+    graph *graphPointer = NULL;
+    graph *oldGraph;
+    serverConfig *config = state->config;
+
+    pthread_mutex_lock(&state->reloadLock);
+
+    loadFiles(config->nodesName, config->edgesName, config->workWithInvalid, config->undirected, &nodesTable,
+              &edgesTable);
+    if (nodesTable && edgesTable) graphPointer = createNewGraph(nodesTable, edgesTable, config->order);
+    if (!graphPointer) {
+        freeHashTable(&nodesTable);
+        freeHashTable(&edgesTable);
+        pthread_mutex_unlock(&state->reloadLock);
+        return FAILURE;
+    }
+
+    pthread_rwlock_wrlock(&state->graphLock);
+    oldGraph = state->graphPointer;
+    oldNodes = state->nodesTable;
+    oldEdges = state->edgesTable;
+    state->graphPointer = graphPointer;
+    state->nodesTable = nodesTable;
+    state->edgesTable = edgesTable;
+    state->generation++;
+    pthread_rwlock_unlock(&state->graphLock);
+
+    freeNewGraph(&oldGraph);
+    freeHashTable(&oldNodes);
+    freeHashTable(&oldEdges);
+
+    pthread_mutex_unlock(&state->reloadLock);
+    return SUCCESS;
+}
+
+/* ____________________________________________________________________________
+
+    char *serverQuery(serverWorker *worker, int source, int target,
+                      int withCut)
+
+    Solves maximal flow between source and target on the view of the
+    worker, the view is created again if the graph was reloaded. Returns
+    allocated answer line (with ids of the cut edges if withCut is set)
+    or NULL if memory can't be allocated.
+   ____________________________________________________________________________
+*/
+static char *serverQuery(serverWorker *worker, int source, int target, int withCut) {
+    int i;
+    int count = 0;
+    int length;
+    int *ids = NULL;
+    char flowText[FLOW_BUFFER_SIZE];
+    char *answer;
+    serverState *state = worker->state;
+
+    pthread_rwlock_rdlock(&state->graphLock);
+
+    if (worker->generation != state->generation) {
+        freeGraphView(&worker->view);
+        worker->view = graphCreateView(state->graphPointer);
+        worker->generation = worker->view ? state->generation : -1;
+    }
+    if (!worker->view) {
+        pthread_rwlock_unlock(&state->graphLock);
+        return NULL;
+    }
+
+    graphResetResidual(worker->view);
+    if (source == target || !graphMaxFlow(worker->view, source, target, state->config->engine, 0, 0)) {
+        pthread_rwlock_unlock(&state->graphLock);
+        answer = malloc(SERVER_LINE_LENGTH);
+        if (answer) strcpy(answer, "ERR invalid source or target\n");
+        return answer;
+    }
+
+    graphFormatFlow(worker->view, worker->view->maxFlow, flowText);
+    if (withCut) {
+        count = graphCutEdges(worker->view, NULL, 0);
+        ids = malloc((count + 1) * sizeof(int));
+        if (ids) graphCutEdges(worker->view, ids, count);
+    }
+    pthread_rwlock_unlock(&state->graphLock);
+
+    /* every id takes at most 12 characters with its space */
+    answer = malloc(SERVER_LINE_LENGTH + (size_t) count * 12);
+    if (!answer || (withCut && !ids)) {
+        free(answer);
+        free(ids);
+        return NULL;
+    }
+
+    if (withCut) {
+        length = sprintf(answer, "OK %s %d", flowText, count);
+        for (i = 0; i < count; i++) length += sprintf(answer + length, " %d", ids[i]);
+        strcpy(answer + length, "\n");
+    } else {
+        sprintf(answer, "OK %s\n", flowText);
+    }
+
+    free(ids);
+    return answer;
+}
+
+/* ____________________________________________________________________________
+
+    int serverCommand(serverWorker *worker, int client, char *line)
+
+    Executes one command line and writes the answer to the client. Returns
+    FAILURE if the connection should be closed.
+   ____________________________________________________________________________
+*/
+static int serverCommand(serverWorker *worker, int client, char *line) {
+    int source;
+    int target;
+    int result;
+    char extra;
+    char answer[SERVER_LINE_LENGTH];
+    char *queryAnswer;
+
+    if (sscanf(line, "FLOW %d %d %c", &source, &target, &extra) == 2
+        || sscanf(line, "CUT %d %d %c", &source, &target, &extra) == 2) {
+        queryAnswer = serverQuery(worker, source, target, line[0] == 'C');
+        if (!queryAnswer) return serverWrite(client, "ERR out of memory\n");
+        result = serverWrite(client, queryAnswer);
+        free(queryAnswer);
+        return result;
+    }
+
+    if (strcmp(line, "RELOAD") == 0) {
+        if (!serverReload(worker->state)) return serverWrite(client, "ERR reload failed\n");
+
+        pthread_rwlock_rdlock(&worker->state->graphLock);
+        sprintf(answer, "OK %d %d\n", worker->state->graphPointer->nodeCount, worker->state->graphPointer->arcCount);
+        pthread_rwlock_unlock(&worker->state->graphLock);
+        return serverWrite(client, answer);
+    }
+
+    if (strcmp(line, "SHUTDOWN") == 0) {
+        serverStop(worker->state);
+        serverWrite(client, "OK\n");
+        return FAILURE;
+    }
+
+    if (strcmp(line, "QUIT") == 0) return FAILURE;
+
+    return serverWrite(client, "ERR unknown command\n");
+}
+
+/* ____________________________________________________________________________
+
+    void serverServe(serverWorker *worker, int client)
+
+    Reads command lines from the client until the client closes the
+    connection, sends QUIT or SHUTDOWN, or the server stops. Closes the
+    connection.
+   ____________________________________________________________________________
+*/
+static void serverServe(serverWorker *worker, int client) {
+    int ready;
+    int filled = 0;
+    ssize_t length;
+    char buffer[SERVER_LINE_LENGTH];
+    char *end;
+    fd_set clients;
+    struct timeval timeout;
+
+    while (!serverIsStopped(worker->state)) {
+        FD_ZERO(&clients);
+        FD_SET(client, &clients);
+        timeout.tv_sec = 0;
+        timeout.tv_usec = SERVER_POLL_MS * 1000;
+
+        ready = select(client + 1, &clients, NULL, NULL, &timeout);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) break;
+        if (ready == 0) continue;
+
+        length = read(client, buffer + filled, SERVER_LINE_LENGTH - 1 - filled);
+        if (length <= 0) break;
+        filled += (int) length;
+
+        while ((end = memchr(buffer, '\n', filled)) != NULL) {
+            *end = '\0';
+            if (end > buffer && end[-1] == '\r') end[-1] = '\0';
+            if (!serverCommand(worker, client, buffer)) {
+                close(client);
+                return;
+            }
+            filled -= (int) (end + 1 - buffer);
+            memmove(buffer, end + 1, filled);
+        }
+
+        /* line which doesn't fit into the buffer is dropped */
+        if (filled == SERVER_LINE_LENGTH - 1) {
+            filled = 0;
+            if (!serverWrite(client, "ERR line too long\n")) break;
+        }
+    }
+
+    close(client);
+}
+
+/* ____________________________________________________________________________
+
+    void *serverWorkerThread(void *argument)
+
+    Takes connections from the queue of serverState and serves them until
+    the server stops.
+   ____________________________________________________________________________
+*/
+static void *serverWorkerThread(void *argument) {
+    int client;
+    serverWorker *worker = argument;
+    serverState *state = worker->state;
+
+    while (1) {
+        pthread_mutex_lock(&state->queueLock);
+        while (state->count == 0 && !state->stopped) pthread_cond_wait(&state->notEmpty, &state->queueLock);
+        if (state->stopped) {
+            pthread_mutex_unlock(&state->queueLock);
+            break;
+        }
+        client = state->connections[state->first];
+        state->first = (state->first + 1) % SERVER_QUEUE_SLOTS;
+        state->count--;
+        pthread_mutex_unlock(&state->queueLock);
+
+        serverServe(worker, client);
+    }
+
+    freeGraphView(&worker->view);
+    return NULL;
+}
+
+/* ____________________________________________________________________________
+
+    int serverListen(char *socketName)
+
+    Creates socket bound to socketName and starts listening. Old socket
+    file left by the previous run is removed, other files are never
+    overwritten. Returns the socket or -1 if error occurred.
+   ____________________________________________________________________________
+*/
+static int serverListen(char *socketName) {
+    int listener;
+    struct sockaddr_un address;
+    struct stat status;
+
+    if (!socketName || strlen(socketName) >= sizeof(address.sun_path)) return -1;
+
+    if (stat(socketName, &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) return -1;
+        unlink(socketName);
+    }
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) return -1;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketName);
+
+    if (bind(listener, (struct sockaddr *) &address, sizeof(address)) < 0 || listen(listener, SERVER_BACKLOG) < 0) {
+        close(listener);
+        return -1;
+    }
+
+    return listener;
+}
+
+/* ____________________________________________________________________________
+
+    void serverAccept(serverState *state, int listener)
+
+    Accepts connections and passes them to the workers until the server
+    stops. When the queue is full, the client gets busy answer.
+   ____________________________________________________________________________
+*/
+static void serverAccept(serverState *state, int listener) {
+    int ready;
+    int client;
+    fd_set listeners;
+    struct timeval timeout;
+
+    while (!serverIsStopped(state)) {
+        FD_ZERO(&listeners);
+        FD_SET(listener, &listeners);
+        timeout.tv_sec = 0;
+        timeout.tv_usec = SERVER_POLL_MS * 1000;
+
+        ready = select(listener + 1, &listeners, NULL, NULL, &timeout);
+        if (ready <= 0) continue;
+
+        client = accept(listener, NULL, NULL);
+        if (client < 0) continue;
+
+        pthread_mutex_lock(&state->queueLock);
+        if (state->count == SERVER_QUEUE_SLOTS) {
+            pthread_mutex_unlock(&state->queueLock);
+            serverWrite(client, "ERR busy\n");
+            close(client);
+            continue;
+        }
+        state->connections[(state->first + state->count) % SERVER_QUEUE_SLOTS] = client;
+        state->count++;
+        pthread_cond_signal(&state->notEmpty);
+        pthread_mutex_unlock(&state->queueLock);
+    }
+}
+
+/* ____________________________________________________________________________
+
+    int serverRun(serverConfig *config, hashTable *nodesTable,
+                  hashTable *edgesTable)
+
+    Builds graph over loaded tables (the server takes them over and frees
+    them) and answers queries on the socket of config until the server is
+    stopped. Returns SUCCESS after clean stop or FAILURE if the server
+    can't be started.
+   ____________________________________________________________________________
+*/
+int serverRun(serverConfig *config, hashTable *nodesTable, hashTable *edgesTable) {
+    int i;
+    int started = 0;
+    int listener = -1;
+    pthread_t *threads;
+    serverWorker *workers;
+    serverState state;
+    struct sigaction action;
+    struct sigaction oldInterrupt;
+    struct sigaction oldTerminate;
+    struct sigaction oldPipe;
+
+    memset(&state, 0, sizeof(serverState));
+    state.config = config;
+    state.nodesTable = nodesTable;
+    state.edgesTable = edgesTable;
+    state.graphPointer = createNewGraph(nodesTable, edgesTable, config->order);
+
+    threads = malloc(config->threads * sizeof(pthread_t));
+    workers = calloc(config->threads, sizeof(serverWorker));
+    if (state.graphPointer && threads && workers) listener = serverListen(config->socketName);
+
+    if (listener < 0) {
+        free(threads);
+        free(workers);
+        freeNewGraph(&state.graphPointer);
+        freeHashTable(&state.nodesTable);
+        freeHashTable(&state.edgesTable);
+        return FAILURE;
+    }
+
+    serverStopped = 0;
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = serverSignal;
+    sigaction(SIGINT, &action, &oldInterrupt);
+    sigaction(SIGTERM, &action, &oldTerminate);
+    /* closed client must not kill the server */
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, &oldPipe);
+
+    pthread_rwlock_init(&state.graphLock, NULL);
+    pthread_mutex_init(&state.reloadLock, NULL);
+    pthread_mutex_init(&state.queueLock, NULL);
+    pthread_cond_init(&state.notEmpty, NULL);
+
+    for (i = 0; i < config->threads; i++) {
+        workers[i].state = &state;
+        workers[i].generation = -1;
+        if (pthread_create(&threads[i], NULL, serverWorkerThread, &workers[i])) break;
+        started++;
+    }
+
+    if (started > 0) {
+        printf("Listening on %s.\n", config->socketName);
+        fflush(stdout);
+        serverAccept(&state, listener);
+    }
+    /* wake up all workers, so they can see that the server stopped */
+    serverStop(&state);
+    for (i = 0; i < started; i++) pthread_join(threads[i], NULL);
+
+    /* connections which were never served */
+    for (i = 0; i < state.count; i++) close(state.connections[(state.first + i) % SERVER_QUEUE_SLOTS]);
+    close(listener);
+    unlink(config->socketName);
+
+    sigaction(SIGINT, &oldInterrupt, NULL);
+    sigaction(SIGTERM, &oldTerminate, NULL);
+    sigaction(SIGPIPE, &oldPipe, NULL);
+
+    pthread_cond_destroy(&state.notEmpty);
+    pthread_mutex_destroy(&state.queueLock);
+    pthread_mutex_destroy(&state.reloadLock);
+    pthread_rwlock_destroy(&state.graphLock);
+
+    free(threads);
+    free(workers);
+    freeNewGraph(&state.graphPointer);
+    freeHashTable(&state.nodesTable);
+    freeHashTable(&state.edgesTable);
+
+    return started > 0 ? SUCCESS : FAILURE;
+}
+
+#else
+
+/* ____________________________________________________________________________
+
+    int serverRun(serverConfig *config, hashTable *nodesTable,
+                  hashTable *edgesTable)
+
+    Unix sockets are not available on this platform, the tables are freed
+    and FAILURE is returned.
+   ____________________________________________________________________________
+*/
+int serverRun(serverConfig *config, hashTable *nodesTable, hashTable *edgesTable) {
+    (void) config;
+    freeHashTable(&nodesTable);
+    freeHashTable(&edgesTable);
+    return FAILURE;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SEMESTRALKA_SERVER_H
+#define SEMESTRALKA_SERVER_H
+
+#include "structs.h"
+
+#define SERVER_DEFAULT_THREADS 4
+#define SERVER_MAX_THREADS 64
+#define SERVER_QUEUE_SLOTS 64
+#define SERVER_BACKLOG 16
+#define SERVER_POLL_MS 200
+#define SERVER_LINE_LENGTH 256
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+typedef struct {
+    char *socketName;
+    char *nodesName;
+    char *edgesName;
+    int workWithInvalid;
+    int undirected;
+    int order;
+    int engine;
+    int threads;
+} serverConfig;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int serverRun(serverConfig *config, hashTable *nodesTable, hashTable *edgesTable);
+
+#endif
@@ -2,6 +2,7 @@
 #define SEMESTRALKA_STRUCTS_H
 
 #include "hashTable.h"
+#include "mapped.h"
 
 /* ____________________________________________________________________________
 
@@ -12,6 +13,7 @@
 typedef struct {
     char *wkt;
     int id;
+    int index;
     int next;
     int level;
 } graphNode;
@@ -20,18 +22,57 @@ typedef struct {
     char *wkt;
     int id;
     char isValid;
+    char isUndirected;
     int source;
     int target;
-    long flow;
-    long capacity;
-    struct graphEdge *reverseEdge;
+    double flow;
+    double capacity;
 } graphEdge;
 
+typedef struct {
+    int id;
+    double limit;
+} graphTerminal;
+
+typedef union {
+    long integer;
+    double real;
+} flowValue;
+
 typedef struct {
     hashTable *nodes;
-    hashTable *edges;
-    long maxFlow;
+    graphNode *nodeList;
+    int nodeCount;
+    int *visited;
+    int visitedCount;
+    int targetCount;
+    int *touched;
+    int touchedCount;
+    char *isTouched;
+    int *firstArc;
+    int *arcs;
+    int arcCount;
+    int *head;
+    int flowType;
+    void *residual;
+    void *capacity;
+    int *firstMember;
+    graphEdge **memberList;
+    flowValue maxFlow;
+    flowValue upperBound;
+    char *bestCut;
+    double timeLimit;
+    double gapLimit;
+    int engine;
     int source;
     int target;
+    int validOnly;
+    int terminalCount;
+    int phaseCount;
+    char *checkpointName;
+    double checkpointInterval;
+    double checkpointTime;
+    char *resumeName;
+    mappedStore *store;
 } graph;
 #endif
@@ -0,0 +1,407 @@
+/* ____________________________________________________________________________
+
+    Module verify.c
+    This module checks the certificate of a solved graph straight over the
+    arrays of the solver: flow of every arc fits into its capacity and
+    matches the flow of its reverse arc, flow is conserved in every node
+    except the source and the target, which send and receive the flow of
+    the graph, and capacity of the cut written by writeToOutputFile (nodes
+    reachable from the source in the residual graph, see
+    graphMarkSourceSide) equals the flow, or the upper bound if the solve
+    was stopped. Then the flow is maximal and the cut minimal. A positive
+    flow must be cut by some edges or limits of terminals, virtual arcs
+    which don't limit their terminals never cross the cut. Every arc
+    is read once, from the node it leaves, so the check is linear in the
+    size of the graph. Nodes are checked by a pool of threads which take
+    chunks of them from a shared counter, without threads they are
+    checked one after another.
+   ____________________________________________________________________________
+*/
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#include <pthread.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include "verify.h"
+#include "graph.h"
+
+typedef struct {
+    graph *graphPointer;
+    FILE *report;
+    int count;
+    int next;
+    long violations;
+    long cutArcs;
+    flowValue cut;
+    flowValue sourceNet;
+    flowValue targetNet;
+#ifdef __unix__
+    pthread_mutex_t lock;
+#endif
+} verifyWork;
+
+/* ____________________________________________________________________________
+
+    void verifyLock(verifyWork *work)
+    void verifyUnlock(verifyWork *work)
+
+    Lock and unlock the shared state of the work.
+   ____________________________________________________________________________
+*/
+static void verifyLock(verifyWork *work) {
+#ifdef __unix__
+    pthread_mutex_lock(&work->lock);
+#endif
+}
+
+static void verifyUnlock(verifyWork *work) {
+#ifdef __unix__
+    pthread_mutex_unlock(&work->lock);
+#endif
+}
+
+/* ____________________________________________________________________________
+
+    int verifyTake(verifyWork *work)
+
+    Takes next chunk of nodes. Returns index of the first node of the
+    chunk, which is not less than count if no nodes are left.
+   ____________________________________________________________________________
+*/
+static int verifyTake(verifyWork *work) {
+    int start;
+
+    verifyLock(work);
+    start = work->next;
+    if (start < work->count) work->next += VERIFY_CHUNK;
+    verifyUnlock(work);
+
+    return start;
+}
+
+/* ____________________________________________________________________________
+
+    void verifyViolation(verifyWork *work, const char *format, ...)
+
+    Counts the violation and writes its description made by format into
+    the report, only first VERIFY_MAX_REPORTS violations are written.
+   ____________________________________________________________________________
+*/
+static void verifyViolation(verifyWork *work, const char *format, ...) {
+    va_list arguments;
+
+    verifyLock(work);
+    if (work->violations++ < VERIFY_MAX_REPORTS && work->report) {
+        va_start(arguments, format);
+        vfprintf(work->report, format, arguments);
+        va_end(arguments);
+    }
+    verifyUnlock(work);
+}
+
+/* ____________________________________________________________________________
+
+    void verifyArc(graph *graphPointer, int arc, flowValue *capacity,
+                   flowValue *residual)
+
+    Reads capacity and residual capacity of the arc.
+   ____________________________________________________________________________
+*/
+static void verifyArc(graph *graphPointer, int arc, flowValue *capacity, flowValue *residual) {
+    switch (graphPointer->flowType) {
+        case FLOW_INT:
+            capacity->integer = ((int *) graphPointer->capacity)[arc];
+            residual->integer = ((int *) graphPointer->residual)[arc];
+            break;
+
+        case FLOW_LONG:
+            capacity->integer = ((long *) graphPointer->capacity)[arc];
+            residual->integer = ((long *) graphPointer->residual)[arc];
+            break;
+
+        default:
+            capacity->real = ((double *) graphPointer->capacity)[arc];
+            residual->real = ((double *) graphPointer->residual)[arc];
+    }
+}
+
+/* ____________________________________________________________________________
+
+    double verifyCapacity(graph *graphPointer, int arc)
+
+    Returns capacity of the arc.
+   ____________________________________________________________________________
+*/
+static double verifyCapacity(graph *graphPointer, int arc) {
+    flowValue capacity;
+    flowValue residual;
+
+    verifyArc(graphPointer, arc, &capacity, &residual);
+    return graphPointer->flowType == FLOW_REAL ? capacity.real : (double) capacity.integer;
+}
+
+/* ____________________________________________________________________________
+
+    int verifyUnlimited(graph *graphPointer, int arc)
+
+    The arc must be a virtual arc of a terminal (see graphAddTerminals).
+    Returns boolean value if the arc doesn't limit the terminal, its
+    capacity isn't smaller than the total capacity of the real arcs out
+    of the terminal (into it for targets).
+   ____________________________________________________________________________
+*/
+static int verifyUnlimited(graph *graphPointer, int arc) {
+    int i;
+    int node;
+    int isSource;
+    int virtualArc = graphPointer->arcCount - 2 * graphPointer->terminalCount;
+    double total = 0;
+
+    isSource = graphPointer->head[REVERSE(arc)] == graphPointer->nodeCount - 2;
+    node = isSource ? graphPointer->head[arc] : graphPointer->head[REVERSE(arc)];
+
+    for (i = graphPointer->firstArc[node]; i < graphPointer->firstArc[node + 1]; i++) {
+        if (graphPointer->arcs[i] >= virtualArc) continue;
+        total += verifyCapacity(graphPointer, isSource ? graphPointer->arcs[i] : REVERSE(graphPointer->arcs[i]));
+    }
+
+    return verifyCapacity(graphPointer, arc) >= total;
+}
+
+/* ____________________________________________________________________________
+
+    int verifyDiffers(graph *graphPointer, flowValue value,
+                      flowValue expected, double scale)
+
+    Returns boolean value if the value isn't equal to the expected one,
+    real values may differ by rounding relative to the scale.
+   ____________________________________________________________________________
+*/
+static int verifyDiffers(graph *graphPointer, flowValue value, flowValue expected, double scale) {
+    if (graphPointer->flowType != FLOW_REAL) return value.integer != expected.integer;
+    return ABS(value.real - expected.real) > VERIFY_EPSILON * (1 + scale);
+}
+
+/* ____________________________________________________________________________
+
+    void verifyNode(verifyWork *work, int node, flowValue *cut,
+                    flowValue *net, long *cutArcs)
+
+    Checks arcs which leave the node and conservation of its flow. Net
+    flow out of the node is stored into net, capacity of its arcs which
+    cross the cut is added to cut and the arcs with capacity are counted
+    in cutArcs. Virtual arc which doesn't limit its terminal never
+    crosses a minimal cut (see graphTerminalLimit).
+   ____________________________________________________________________________
+*/
+static void verifyNode(verifyWork *work, int node, flowValue *cut, flowValue *net, long *cutArcs) {
+    int i;
+    int arc;
+    int head;
+    int real;
+    int crosses;
+    int virtualArc;
+    double through = 0;
+    flowValue zero;
+    flowValue flow;
+    flowValue pair;
+    flowValue capacity;
+    flowValue residual;
+    flowValue reverseCapacity;
+    flowValue reverseResidual;
+    char flowText[FLOW_BUFFER_SIZE];
+    char capacityText[FLOW_BUFFER_SIZE];
+    graph *graphPointer = work->graphPointer;
+    graphNode *nodeList = graphPointer->nodeList;
+
+    real = graphPointer->flowType == FLOW_REAL;
+    virtualArc = graphPointer->arcCount - 2 * graphPointer->terminalCount;
+    memset(&zero, 0, sizeof(flowValue));
+    *net = zero;
+
+    for (i = graphPointer->firstArc[node]; i < graphPointer->firstArc[node + 1]; i++) {
+        arc = graphPointer->arcs[i];
+        head = graphPointer->head[arc];
+        verifyArc(graphPointer, arc, &capacity, &residual);
+        verifyArc(graphPointer, REVERSE(arc), &reverseCapacity, &reverseResidual);
+        crosses = nodeList[node].level != -1 && nodeList[head].level == -1;
+
+        if (real) {
+            flow.real = capacity.real - residual.real;
+            net->real += flow.real;
+            through += ABS(flow.real);
+            if (crosses) cut->real += capacity.real;
+            crosses = crosses && capacity.real > 0;
+            residual.real += reverseResidual.real;
+            pair.real = capacity.real + reverseCapacity.real;
+        } else {
+            flow.integer = capacity.integer - residual.integer;
+            net->integer += flow.integer;
+            if (crosses) cut->integer += capacity.integer;
+            crosses = crosses && capacity.integer > 0;
+            residual.integer += reverseResidual.integer;
+            pair.integer = capacity.integer + reverseCapacity.integer;
+        }
+
+        if (crosses && arc >= virtualArc && verifyUnlimited(graphPointer, arc)) {
+            verifyViolation(work, "Cut crosses the virtual arc of terminal %d, which doesn't limit it.\n",
+                            nodeList[node].id != -1 ? nodeList[node].id : nodeList[head].id);
+        } else if (crosses) {
+            (*cutArcs)++;
+        }
+
+        /* flow over the capacity leaves negative residual capacity */
+        if (real ? flow.real - capacity.real > VERIFY_EPSILON * (1 + capacity.real)
+                 : flow.integer > capacity.integer) {
+            verifyViolation(work, "Arc %d from node %d to node %d carries %s, more than its capacity %s.\n", arc,
+                            nodeList[node].id, nodeList[head].id, graphFormatFlow(graphPointer, flow, flowText),
+                            graphFormatFlow(graphPointer, capacity, capacityText));
+        }
+
+        /* both arcs of the pair keep the same flow in opposite directions, the pair is checked once */
+        if (!(arc & 1) && verifyDiffers(graphPointer, residual, pair, real ? pair.real : 0)) {
+            verifyViolation(work, "Arc %d from node %d to node %d doesn't carry the flow of its reverse arc.\n",
+                            arc, nodeList[node].id, nodeList[head].id);
+        }
+    }
+
+    if (node == graphPointer->source || node == graphPointer->target) return;
+    if (verifyDiffers(graphPointer, *net, zero, through)) {
+        verifyViolation(work, "Node %d doesn't conserve the flow, its net outflow is %s.\n",
+                        nodeList[node].id, graphFormatFlow(graphPointer, *net, flowText));
+    }
+}
+
+/* ____________________________________________________________________________
+
+    void *verifyWorker(void *argument)
+
+    Checks chunks of nodes of the work until none is left, then adds the
+    capacity of the cut, arcs of the cut and net flows of the source and
+    the target which it found to the work.
+   ____________________________________________________________________________
+*/
+static void *verifyWorker(void *argument) {
+    int i;
+    int start;
+    int real;
+    long cutArcs = 0;
+    verifyWork *work = argument;
+    graph *graphPointer = work->graphPointer;
+    flowValue net;
+    flowValue cut;
+    flowValue sourceNet;
+    flowValue targetNet;
+
+    real = graphPointer->flowType == FLOW_REAL;
+    memset(&cut, 0, sizeof(flowValue));
+    sourceNet = cut;
+    targetNet = cut;
+
+    while ((start = verifyTake(work)) < work->count) {
+        for (i = start; i < start + VERIFY_CHUNK && i < work->count; i++) {
+            verifyNode(work, i, &cut, &net, &cutArcs);
+            if (i == graphPointer->source) sourceNet = net;
+            if (i == graphPointer->target) targetNet = net;
+        }
+    }
+
+    verifyLock(work);
+    work->cutArcs += cutArcs;
+    if (real) {
+        work->cut.real += cut.real;
+        work->sourceNet.real += sourceNet.real;
+        work->targetNet.real -= targetNet.real;
+    } else {
+        work->cut.integer += cut.integer;
+        work->sourceNet.integer += sourceNet.integer;
+        work->targetNet.integer -= targetNet.integer;
+    }
+    verifyUnlock(work);
+
+    return NULL;
+}
+
+/* ____________________________________________________________________________
+
+    int graphVerifyFlow(graph *graphPointer, int threads, FILE *report)
+
+    The graph must be solved. Checks by threads threads that the flow of
+    the graph is feasible and that the cut which is written out has the
+    capacity of the flow (of the upper bound if the solve was stopped),
+    violations are described in the report (see verifyViolation). Returns
+    number of violations or -1 if error occurred.
+   ____________________________________________________________________________
+*/
+int graphVerifyFlow(graph *graphPointer, int threads, FILE *report) {
+    int real;
+    int positive;
+    double scale;
+    verifyWork work;
+    char flowText[FLOW_BUFFER_SIZE];
+    char expectedText[FLOW_BUFFER_SIZE];
+#ifdef __unix__
+    pthread_t workers[VERIFY_MAX_THREADS];
+    int started = 0;
+    int i;
+#endif
+
+    if (!graphPointer || threads < 1 || threads > VERIFY_MAX_THREADS) return -1;
+
+    /* the cut is the same one which writeToOutputFile writes */
+    graphMarkSourceSide(graphPointer);
+
+    memset(&work, 0, sizeof(verifyWork));
+    work.graphPointer = graphPointer;
+    work.report = report;
+    work.count = graphPointer->nodeCount;
+    real = graphPointer->flowType == FLOW_REAL;
+
+#ifdef __unix__
+    pthread_mutex_init(&work.lock, NULL);
+    for (i = 0; i < threads && i * VERIFY_CHUNK < work.count; i++) {
+        if (pthread_create(&workers[started], NULL, verifyWorker, &work) == 0) started++;
+    }
+    for (i = 0; i < started; i++) pthread_join(workers[i], NULL);
+#endif
+
+    /* nodes which no thread took are checked here */
+    if (work.next < work.count) verifyWorker(&work);
+
+    scale = real ? ABS(graphPointer->upperBound.real) : 0;
+    if (verifyDiffers(graphPointer, work.sourceNet, graphPointer->maxFlow, scale)) {
+        verifyViolation(&work, "Source sends %s, but the flow is %s.\n",
+                        graphFormatFlow(graphPointer, work.sourceNet, flowText),
+                        graphFormatFlow(graphPointer, graphPointer->maxFlow, expectedText));
+    }
+    if (verifyDiffers(graphPointer, work.targetNet, graphPointer->maxFlow, scale)) {
+        verifyViolation(&work, "Target receives %s, but the flow is %s.\n",
+                        graphFormatFlow(graphPointer, work.targetNet, flowText),
+                        graphFormatFlow(graphPointer, graphPointer->maxFlow, expectedText));
+    }
+    if (graphPointer->nodeList[graphPointer->source].level == -1
+        || graphPointer->nodeList[graphPointer->target].level != -1) {
+        verifyViolation(&work, "Cut doesn't separate the source from the target.\n");
+    }
+    positive = real ? graphPointer->maxFlow.real > 0 : graphPointer->maxFlow.integer > 0;
+    if (positive && !work.cutArcs) {
+        verifyViolation(&work, "Flow is positive, but no edge or limit of a terminal crosses the cut.\n");
+    }
+    if (verifyDiffers(graphPointer, work.cut, graphPointer->upperBound, scale)) {
+        verifyViolation(&work, "Capacity of the cut is %s, but the %s is %s.\n",
+                        graphFormatFlow(graphPointer, work.cut, flowText),
+                        graphIsExact(graphPointer) ? "flow" : "upper bound",
+                        graphFormatFlow(graphPointer, graphPointer->upperBound, expectedText));
+    }
+
+#ifdef __unix__
+    pthread_mutex_destroy(&work.lock);
+#endif
+
+    if (report && work.violations > VERIFY_MAX_REPORTS) {
+        fprintf(report, "%ld more violations were not described.\n", work.violations - VERIFY_MAX_REPORTS);
+    }
+    return (int) (work.violations > INT_MAX ? INT_MAX : work.violations);
+}
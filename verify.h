@@ -0,0 +1,20 @@
+#ifndef SEMESTRALKA_VERIFY_H
+#define SEMESTRALKA_VERIFY_H
+
+#include <stdio.h>
+#include "structs.h"
+
+#define VERIFY_MAX_THREADS 64
+#define VERIFY_CHUNK 4096
+#define VERIFY_MAX_REPORTS 20
+#define VERIFY_EPSILON 1e-9
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int graphVerifyFlow(graph *graphPointer, int threads, FILE *report);
+
+#endif
@@ -0,0 +1,198 @@
+/* ____________________________________________________________________________
+
+    Module vital.c
+    This module finds the most vital edges of the solved graph, edges whose
+    removal lowers the maximal flow the most. Every edge is evaluated from
+    the maximal flow which was already found, its capacity is taken away
+    and only the flow which doesn't fit any more is moved (see
+    graphRemovalDrop), so edges which don't carry much flow cost almost
+    nothing. Edges are evaluated by a pool of threads, every thread has its
+    own view of the graph (see graphCreateView) and takes chunks of edges
+    from a shared counter. Without threads the edges are evaluated one
+    after another.
+   ____________________________________________________________________________
+*/
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#include <pthread.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include "vital.h"
+#include "graph.h"
+
+typedef struct {
+    graphEdge *edgePointer;
+    int arc;
+    flowValue drop;
+    double value;
+} vitalEdge;
+
+typedef struct {
+    graph *graphPointer;
+    vitalEdge *edges;
+    int count;
+    int next;
+#ifdef __unix__
+    pthread_mutex_t lock;
+#endif
+} vitalWork;
+
+/* ____________________________________________________________________________
+
+    int vitalTake(vitalWork *work)
+
+    Takes next chunk of edges. Returns index of the first edge of the
+    chunk, which is not less than count if no edges are left.
+   ____________________________________________________________________________
+*/
+static int vitalTake(vitalWork *work) {
+    int start;
+
+#ifdef __unix__
+    pthread_mutex_lock(&work->lock);
+#endif
+    start = work->next;
+    if (start < work->count) work->next += VITAL_CHUNK;
+#ifdef __unix__
+    pthread_mutex_unlock(&work->lock);
+#endif
+
+    return start;
+}
+
+/* ____________________________________________________________________________
+
+    void *vitalWorker(void *argument)
+
+    Evaluates chunks of edges of the work until none is left. Every edge
+    starts from the maximal flow of the solved graph.
+   ____________________________________________________________________________
+*/
+static void *vitalWorker(void *argument) {
+    int i;
+    int start;
+    vitalWork *work = argument;
+    graph *view = graphCreateView(work->graphPointer);
+
+    /* edges are left for the other threads */
+    if (!view) return NULL;
+
+    view->source = work->graphPointer->source;
+    view->target = work->graphPointer->target;
+    view->engine = ENGINE_DINIC;
+    view->timeLimit = 0;
+    view->gapLimit = 0;
+    view->touchedCount = -1;
+    graphRestoreResidual(view, work->graphPointer);
+
+    while ((start = vitalTake(work)) < work->count) {
+        for (i = start; i < start + VITAL_CHUNK && i < work->count; i++) {
+            graphRemovalDrop(view, work->edges[i].arc, work->edges[i].edgePointer, &work->edges[i].drop);
+            graphRestoreResidual(view, work->graphPointer);
+        }
+    }
+
+    freeGraphView(&view);
+    return NULL;
+}
+
+/* ____________________________________________________________________________
+
+    int compareDrop(const void *first, const void *second)
+
+    Compares two evaluated edges for qsort, bigger drop goes first, edges
+    with the same drop are ordered by id.
+   ____________________________________________________________________________
+*/
+static int compareDrop(const void *first, const void *second) {
+    const vitalEdge *a = first;
+    const vitalEdge *b = second;
+
+    if (a->value != b->value) return a->value > b->value ? -1 : 1;
+    return a->edgePointer->id - b->edgePointer->id;
+}
+
+/* ____________________________________________________________________________
+
+    int graphVitalEdges(graph *graphPointer, char *fileName, int top,
+                        int threads)
+
+    The graph must hold exact maximal flow. Finds drop of the maximal flow
+    for removal of every edge of the graph by threads threads and writes
+    edges whose removal lowers the flow into the file, sorted from the
+    biggest drop. If top is positive, only top edges are written. Returns
+    SUCCESS or FAILURE if error occurred.
+   ____________________________________________________________________________
+*/
+int graphVitalEdges(graph *graphPointer, char *fileName, int top, int threads) {
+    int i;
+    int j;
+    int count = 0;
+    vitalWork work;
+    char dropText[FLOW_BUFFER_SIZE];
+    FILE *file;
+#ifdef __unix__
+    pthread_t workers[VITAL_MAX_THREADS];
+    int started = 0;
+#endif
+
+    if (!graphPointer || !fileName || !graphIsExact(graphPointer)) return FAILURE;
+    if (threads < 1 || threads > VITAL_MAX_THREADS) return FAILURE;
+
+    work.graphPointer = graphPointer;
+    work.edges = malloc((graphPointer->firstMember[graphPointer->arcCount] + 1) * sizeof(vitalEdge));
+    if (!work.edges) return FAILURE;
+
+    /* edges without capacity can't lower the flow */
+    for (i = 0; i < graphPointer->arcCount; i++) {
+        for (j = graphPointer->firstMember[i]; j < graphPointer->firstMember[i + 1]; j++) {
+            if (graphPointer->memberList[j]->capacity <= 0) continue;
+            work.edges[count].edgePointer = graphPointer->memberList[j];
+            work.edges[count].arc = i;
+            count++;
+        }
+    }
+    work.count = count;
+    work.next = 0;
+
+#ifdef __unix__
+    pthread_mutex_init(&work.lock, NULL);
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&workers[started], NULL, vitalWorker, &work) == 0) started++;
+    }
+    for (i = 0; i < started; i++) pthread_join(workers[i], NULL);
+    pthread_mutex_destroy(&work.lock);
+#endif
+
+    /* edges which no thread took are evaluated here */
+    if (work.next < work.count) vitalWorker(&work);
+    if (work.next < work.count) {
+        free(work.edges);
+        return FAILURE;
+    }
+
+    for (i = 0; i < count; i++) {
+        work.edges[i].value = graphPointer->flowType == FLOW_REAL ? work.edges[i].drop.real
+                                                                  : (double) work.edges[i].drop.integer;
+    }
+    qsort(work.edges, count, sizeof(vitalEdge), compareDrop);
+
+    file = fopen(fileName, "w");
+    if (!file) {
+        free(work.edges);
+        return FAILURE;
+    }
+
+    fprintf(file, VITAL_HEADER);
+    for (i = 0; i < count && (top <= 0 || i < top) && work.edges[i].value > FLOW_EPSILON; i++) {
+        graphFormatFlow(graphPointer, work.edges[i].drop, dropText);
+        fprintf(file, "%d,%d,%d,%.15g,%s,%s", work.edges[i].edgePointer->id, work.edges[i].edgePointer->source,
+                work.edges[i].edgePointer->target, work.edges[i].edgePointer->capacity, dropText,
+                work.edges[i].edgePointer->wkt);
+    }
+
+    free(work.edges);
+    fclose(file);
+    return SUCCESS;
+}
@@ -0,0 +1,19 @@
+#ifndef SEMESTRALKA_VITAL_H
+#define SEMESTRALKA_VITAL_H
+
+#include "structs.h"
+
+#define VITAL_HEADER "id,source,target,capacity,drop,WKT\n"
+#define VITAL_DEFAULT_THREADS 4
+#define VITAL_MAX_THREADS 64
+#define VITAL_CHUNK 64
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+int graphVitalEdges(graph *graphPointer, char *fileName, int top, int threads);
+
+#endif